@@ -15,9 +15,10 @@
 ** The INA226 is set up to measure using the maximum conversion length (and maximum accuracy) and then average    **
 ** those readings 64 times. This results in readings taking 8.244ms x 64 = 527.616ms or just less than 2 times    **
 ** a second. The pin-change interrupt handler is called when a reading is finished and the INA226 pulls the pin   **
-** down to ground, it resets the pin status and adds the readings to the global variables. The main program will  **
-** do whatever processing it has to and every 5 seconds it will display the current averaged readings and reset   **
-** them.                                                                                                          **
+** down to ground, it has the INA226_Sampler class capture the raw readings into its ring buffer which also       **
+** resets the pin status. The main program will do whatever processing it has to, takes the readings out of the   **
+** buffer and after every 10 readings it will display the averaged readings and reset them. As the interrupt      **
+** handler and the main program no longer share any variables, interrupts never need to be disabled in loop().    **
 **                                                                                                                **
 ** The datasheet for the INA226 can be found at http://www.ti.com/lit/ds/symlink/ina226.pdf and it contains the   **
 ** information required in order to hook up the device. Unfortunately it comes as a VSSOP package but it can be   **
@@ -38,6 +39,7 @@
 **                                                                                                                **
 ** Vers.  Date       Developer                     Comments                                                       **
 ** ====== ========== ============================= ============================================================== **
+** 1.0.5   2026-10-16 https://github.com/SV-Zanshin Use the INA226_Sampler ring buffer instead of volatile sums   **
 ** 1.0.4   2018-05-29 https://github.com/SV-Zanshin Added checking if the device is actually detected to code     **
 ** 1.0.3   2017-09-29 https://github.com/SV-Zanshin https://github.com/SV-Zanshin/INA226/issues/8. Default values **
 ** 1.0.2   2017-08-10 https://github.com/SV-Zanshin Further changes to comments                                   **
@@ -55,10 +57,11 @@ const uint32_t SERIAL_SPEED       = 115200;                                   //
 /*******************************************************************************************************************
 ** Declare global variables and instantiate classes                                                               **
 *******************************************************************************************************************/
-INA226_Class INA226;                                                          // INA class instantiation          //
-volatile uint64_t sumBusMillVolts =      0;                                   // Sum of bus voltage readings      //
-volatile int64_t  sumBusMicroAmps =      0;                                   // Sum of bus amperage readings     //
-volatile uint8_t  readings        =      0;                                   // Number of measurements taken     //
+INA226_Class   INA226;                                                        // INA class instantiation          //
+INA226_Sampler Sampler(INA226);                                               // Sampling engine instantiation    //
+uint64_t sumBusMillVolts =      0;                                            // Sum of bus voltage readings      //
+int64_t  sumBusMicroAmps =      0;                                            // Sum of bus amperage readings     //
+uint8_t  readings        =      0;                                            // Number of measurements taken     //
 /*******************************************************************************************************************
 ** Declare interrupt service routine for the pin-change interrupt on pin 8 which is set in the setup() method     **
 *******************************************************************************************************************/
@@ -67,10 +70,7 @@ ISR (PCINT0_vect) {                                                           //
   *digitalPinToPCMSK(INA226_ALERT_PIN)&=~bit(digitalPinToPCMSKbit(INA226_ALERT_PIN)); // Disable PCMSK pin        //
   PCICR  &= ~bit(digitalPinToPCICRbit(INA226_ALERT_PIN));                     // disable interrupt for the group  //
   sei();                                                                      // Enable interrupts for I2C calls  //
-  sumBusMillVolts += INA226.getBusMilliVolts();                               // Read the current value           //
-  sumBusMicroAmps += INA226.getBusMicroAmps();                                // Read the current value           //
-  readings++;                                                                 // Increment the number of readings //
-  INA226.waitForConversion();                                                 // Resets INA226 interrupt flag     //
+  Sampler.sampleISR();                                                        // Capture and reset INA226 flag    //
   cli();                                                                      // Disable interrupts               //
   *digitalPinToPCMSK(INA226_ALERT_PIN)|=bit(digitalPinToPCMSKbit(INA226_ALERT_PIN)); // Enable PCMSK pin          //
   PCIFR  |= bit (digitalPinToPCICRbit(INA226_ALERT_PIN));                     // clear any outstanding interrupt  //
@@ -102,7 +102,8 @@ void setup() {                                                                //
   INA226.setBusConversion(7);                                                 // Maximum conversion time 8.244ms  //
   INA226.setShuntConversion(7);                                               // Maximum conversion time 8.244ms  //
   INA226.setMode(INA_MODE_CONTINUOUS_BOTH);                                   // Bus/shunt measured continuously  //
-  INA226.setAlertPinOnConversion(true);                                       // Make alert pin go low on finish  //
+  Sampler.begin(INA_SAMPLE_BUS|INA_SAMPLE_CURRENT);                           // Sample bus and current, make the //
+                                                                              // alert pin go low on finish       //
 } // of method setup()                                                        //                                  //
 /*******************************************************************************************************************
 ** This is the main program for the Arduino IDE, it is called in an infinite loop. The INA226 measurements are    **
@@ -110,10 +111,21 @@ void setup() {                                                                //
 *******************************************************************************************************************/
 void loop() {                                                                 // Main program loop                //
   static long lastMillis = millis();                                          // Store the last time we printed   //
+  static inaSample samples[4];                                                // Samples taken out of the buffer  //
+  /*****************************************************************************************************************
+  ** Take all samples captured by the interrupt handler out of the buffer and add them to the running totals      **
+  *****************************************************************************************************************/
+  uint8_t count;                                                              // Number of samples read           //
+  while ((count=Sampler.read(samples,4))>0) {                                 // Loop until the buffer is empty   //
+    for (uint8_t i=0;i<count;i++) {                                           // Add each sample to the totals    //
+      sumBusMillVolts += samples[i].busMilliVolts;                            //                                  //
+      sumBusMicroAmps += samples[i].busMicroAmps;                             //                                  //
+      readings++;                                                             // Increment the number of readings //
+    } // of for-next each sample                                              //                                  //
+  } // of while samples in buffer                                             //                                  //
   /*****************************************************************************************************************
   ** Check to see if we have collected 10 or more readings each main loop iteration, and display the time and     **
-  ** average information before resetting the values. Interrupts are turned off when resetting the values to      **
-  ** ensure atomic operations                                                                                     **
+  ** average information before resetting the values                                                              **
   *****************************************************************************************************************/
   if (readings>=10) {                                                         // If it is time to display results //
     Serial.print(F("Averaging readings taken over "));                        //                                  //
@@ -123,11 +135,13 @@ void loop() {                                                                 //
     Serial.print(F("V\nBus amperage:  "));                                    //                                  //
     Serial.print((float)sumBusMicroAmps/readings/1000.0,4);                   //                                  //
     Serial.print(F("mA\n\n"));                                                //                                  //
+    if (Sampler.getOverflows()>0) {                                           // Show if readings were lost       //
+      Serial.print(Sampler.getOverflows());                                   //                                  //
+      Serial.print(F(" readings lost as the buffer was full.\n\n"));          //                                  //
+    } // of if-then samples lost                                              //                                  //
     lastMillis = millis();                                                    //                                  //
-    cli();                                                                    // Disable interrupts               //
     readings        = 0;                                                      // Reset values                     //
     sumBusMillVolts = 0;                                                      // Reset values                     //
     sumBusMicroAmps = 0;                                                      // Reset values                     //
-    sei();                                                                    // Enable interrupts                //
   } // of if-then we've reached the required amount of readings               //                                  //
 } // of method loop                                                           //----------------------------------//
@@ -15,7 +15,74 @@
 #include "INA226.h"                                                           // Include the header definition    //
 #include <Wire.h>                                                             // I2C Library definition           //
 #include <EEPROM.h>                                                           // Include the EEPROM library       //
-INA226_Class::INA226_Class()  {}                                              // Class constructor                //
+static const uint16_t conversionTimes[8] = {140,204,332,588,1100,2116,4156,   // Conversion time in microseconds  //
+                                            8244};                            // for each of the 8 settings       //
+static const uint16_t averagingCounts[8] = {1,4,16,64,128,256,512,1024};      // Averages for each setting        //
+#ifdef INA_INSTRUMENTATION                                                    // Only when instrumented           //
+  /*****************************************************************************************************************
+  ** Class inaApiTimer adds the time from its construction to the end of the enclosing method to a histogram.     **
+  ** INA_TIME_API() creates one at the start of a public method, INA_COUNT_TRANSFER() counts an I2C transaction.  **
+  ** Without INA_INSTRUMENTATION both macros are empty.                                                           **
+  *****************************************************************************************************************/
+  class inaApiTimer {                                                         // Time a method call               //
+    public:                                                                   // Publicly visible methods         //
+      inaApiTimer(inaHistogram &histogram) :                                  // Start timing                     //
+        _Histogram(histogram), _Start(micros()) {}                            //                                  //
+      ~inaApiTimer() {                                                        // Count the duration               //
+        uint32_t elapsed = micros()-_Start;                                   //                                  //
+        uint8_t  bucket  = 0;                                                 // Number of significant bits       //
+        while (elapsed>0 && bucket<INA_HISTOGRAM_BUCKETS-1) {                 //                                  //
+          elapsed >>= 1;                                                      //                                  //
+          bucket++;                                                           //                                  //
+        } // of while bits left                                               //                                  //
+        if (_Histogram.buckets[bucket]<UINT16_MAX) _Histogram.buckets[bucket]++;// Saturate instead of wrap       //
+      } // of destructor                                                      //                                  //
+    private:                                                                  // Private variables and methods    //
+      inaHistogram &_Histogram;                                               // Histogram of the API group       //
+      uint32_t      _Start;                                                   // micros() at the start            //
+  }; // of class inaApiTimer                                                  //                                  //
+  #define INA_TIME_API(api) inaApiTimer apiTimer(_Histograms[api])            // Time the enclosing method        //
+  #define INA_COUNT_TRANSFER(deviceAddress,addr,bytes,status,hold)            \
+          countTransfer(deviceAddress,addr,bytes,status,hold)                 // Count a transaction              //
+#else                                                                         // Not instrumented                 //
+  #define INA_TIME_API(api)                                                   // Nothing to do                    //
+  #define INA_COUNT_TRANSFER(deviceAddress,addr,bytes,status,hold)            //                                  //
+#endif                                                                        // of if-then instrumentation       //
+/*******************************************************************************************************************
+** Class inaInterruptLock disables interrupts from its construction to the end of the enclosing block and then    **
+** restores the state the caller had, so that data shared with an interrupt handler can be changed safely from    **
+** loop(), from another interrupt handler or with interrupts already disabled. AVR saves the status register and  **
+** Cortex-M cores the PRIMASK register, other cores can only enable interrupts again at the end.                  **
+*******************************************************************************************************************/
+class inaInterruptLock {                                                      // Interrupts off in a block        //
+  public:                                                                     // Publicly visible methods         //
+    #if defined(SREG)                                                         // AVR and the host build           //
+      inaInterruptLock() : _State(SREG) {cli();}                              // Save and disable                 //
+      ~inaInterruptLock() {SREG = _State;}                                    // Restore                          //
+    private:                                                                  // Private variables and methods    //
+      uint8_t  _State;                                                        // Status register of the caller    //
+    #elif defined(__CORTEX_M)                                                 // ARM cores with CMSIS             //
+      inaInterruptLock() : _State(__get_PRIMASK()) {__disable_irq();}         // Save and disable                 //
+      ~inaInterruptLock() {__set_PRIMASK(_State);}                            // Restore                          //
+    private:                                                                  // Private variables and methods    //
+      uint32_t _State;                                                        // PRIMASK of the caller            //
+    #else                                                                     // Other cores                      //
+      inaInterruptLock() {noInterrupts();}                                    // Disable                          //
+      ~inaInterruptLock() {interrupts();}                                     // Enable                           //
+    #endif                                                                    // of if-then-else core             //
+}; // of class inaInterruptLock                                               //                                  //
+static INA226_WireTransport wireTransport;                                    // Transport of INA226_Class()      //
+INA226_Class::INA226_Class() : _Transport(&wireTransport) {                   // Class constructor, uses Wire     //
+  memset(_RegisterPointer,INA_UNKNOWN_POINTER,sizeof(_RegisterPointer));      // No pointers written yet          //
+  memset(_Conversions,0,sizeof(_Conversions));                                // No conversions started yet       //
+  memset(_Devices,0,sizeof(_Devices));                                        // Zero padding for EEPROM record   //
+  #ifdef INA_INSTRUMENTATION                                                  // Only when instrumented           //
+    resetInstrumentation();                                                   // Clear counters and histograms    //
+  #endif                                                                      // of if-then instrumentation       //
+} // of class constructor                                                     //                                  //
+INA226_Class::INA226_Class(INA226_Transport &transport) : INA226_Class() {    // Class constructor for another    //
+  _Transport = &transport;                                                    // transport                        //
+} // of class constructor                                                     //                                  //
 INA226_Class::~INA226_Class() {}                                              // Unused class destructor          //
 /*******************************************************************************************************************
 ** Method begin() sets the INA226 Configuration details, without which meaningful readings cannot be made. If it  **
@@ -25,111 +92,311 @@ INA226_Class::~INA226_Class() {}                                              //
 uint8_t INA226_Class::begin(const uint8_t maxBusAmps,                         // Class initializer                //
                             const uint32_t microOhmR,                         //                                  //
                             const uint8_t deviceNumber ) {                    //                                  //
+  INA_TIME_API(INA_API_BEGIN);                                                // Time the call when instrumented  //
+  inaDet ina;                                                                 // Hold device details in structure //
+  computeCalibration(maxBusAmps,microOhmR,ina);                               // Compute calibration and LSBs     //
+  return beginDevices(ina,deviceNumber);                                      // Scan and write calibration       //
+} // of method begin()                                                        //                                  //
+/*******************************************************************************************************************
+** Method fastBegin initializes the devices from the topology record written by saveDevices() at "eepromAddress". **
+** Each recorded device is only confirmed by reading its manufacturer ID, and devices which still hold the        **
+** recorded calibration and configuration, e.g. after a reset of the Arduino alone, are left untouched so that    **
+** their readings continue without a gap. The requested calibration replaces the recorded one before anything     **
+** is written, so that a changed shunt or maximum current only writes the new value. If the record is missing or  **
+** invalid or any device doesn't answer then the bus is scanned as in begin(). The record is then saved again,    **
+** EEPROM.put() only writing the bytes which differ. Returns the number of devices found.                         **
+*******************************************************************************************************************/
+uint8_t INA226_Class::fastBegin(const uint8_t maxBusAmps,                     // Initialize from the EEPROM       //
+                                const uint32_t microOhmR,                     // record, scan only if needed      //
+                                const uint16_t eepromAddress) {               //                                  //
+  INA_TIME_API(INA_API_BEGIN);                                                //                                  //
   inaDet ina;                                                                 // Hold device details in structure //
-  uint16_t manufacturerId;                                                    // Read manufacturerId from device  //
+  computeCalibration(maxBusAmps,microOhmR,ina);                               // Compute calibration and LSBs     //
+  if (restoreDevices(eepromAddress,&ina)==0 &&                                // Fails if any device is missing,  //
+      beginDevices(ina,UINT8_MAX)==0) return 0;                               // then scan the bus                //
+  return saveDevices(eepromAddress);                                          // Record the new topology          //
+} // of method fastBegin()                                                    //                                  //
+/*******************************************************************************************************************
+** Method computeCalibration computes the current LSB, calibration register and power LSB for the maximum current **
+** and shunt resistance given                                                                                     **
+*******************************************************************************************************************/
+void INA226_Class::computeCalibration(const uint8_t maxBusAmps,               // Calibration and LSBs for the     //
+                                      const uint32_t microOhmR,               // current and shunt given          //
+                                      inaDet &ina) {                          //                                  //
+  ina.current_LSB = (uint64_t)maxBusAmps*1000000000/32767;                    // Get the best possible LSB in nA  //
+  ina.calibration = (uint64_t)51200000 / ((uint64_t)ina.current_LSB *         // Compute calibration register     //
+                    (uint64_t)microOhmR / (uint64_t)100000);                  // using 64 bit numbers throughout  //
+  ina.power_LSB   = (uint32_t)25*ina.current_LSB;                             // Fixed multiplier for INA219      //
+  #ifdef debug_Mode                                                           // Display values when debugging    //
+  Serial.print(F("current_LSB = ")); Serial.println(ina.current_LSB);         //                                  //
+  Serial.print(F("calibration = ")); Serial.println(ina.calibration);         //                                  //
+  Serial.print(F("power_LSB   = ")); Serial.println(ina.power_LSB);           //                                  //
+  #endif                                                                      // end of conditional compile code  //
+} // of method computeCalibration()                                           //                                  //
+/*******************************************************************************************************************
+** Method beginDevices enumerates the INA226 devices on the first call and then stores the calibration, current   **
+** and power LSBs of "calibrated" in the table entry of the device or all devices and writes the calibration      **
+** register. It is shared by begin() and the INA226_Fixed template, which computes the values at compile time.    **
+*******************************************************************************************************************/
+uint8_t INA226_Class::beginDevices(const inaDet &calibrated,                  // Scan and write calibration       //
+                                   const uint8_t deviceNumber) {              //                                  //
   if (_DeviceCount==0) {                                                      // Enumerate devices in first call  //
-    Wire.begin();                                                             // Start the I2C wire subsystem     //
+    _Transport->begin();                                                      // Start the I2C bus if needed      //
     for(uint8_t deviceAddress = 64;deviceAddress<79;deviceAddress++) {        // Loop for each possible address   //
-      Wire.beginTransmission(deviceAddress);                                  // See if something is at address   //
-      if (Wire.endTransmission() == 0) {                                      // by checking the return error     //
-        if (readWord(INA_MANUFACTURER_ID_REGISTER,deviceAddress)==0x5449) {   // Check hard-coded manufacturerId  //
+      if (_Transport->write(deviceAddress,NULL,0,true)==0) {                  // See if something is at address   //
+        if (readWord(INA_MANUFACTURER_ID_REGISTER,deviceAddress)==            // Check the manufacturerId         //
+            INA_MANUFACTURER_ID) {                                            //                                  //
           writeWord(INA_CONFIGURATION_REGISTER,INA_RESET_DEVICE,deviceAddress);// Force INAs to reset             //
           delay(I2C_DELAY);                                                   // Wait for INA to finish resetting //
           if (readWord(INA_CONFIGURATION_REGISTER,deviceAddress)              // Yes, we've found an INA226!      //
               ==INA_DEFAULT_CONFIGURATION) {                                  //                                  //
-            ina.address       = deviceAddress;                                // Store device address             //
-            ina.operatingMode = B111;                                         // Default to continuous mode       //
-            if ((_DeviceCount*sizeof(ina))<EEPROM.length()) {                 // If there's space left in EEPROM  //
-              EEPROM.put(_DeviceCount*sizeof(ina),ina);                       // Add the structure                //
+            if (_DeviceCount<INA_MAX_DEVICES) {                               // If there's space left in table   //
+              _Devices[_DeviceCount].address       = deviceAddress;           // Store device address             //
+              _Devices[_DeviceCount].operatingMode = B111;                    // Default to continuous mode       //
+              _Devices[_DeviceCount].configuration =                          // Configuration after the reset    //
+                INA_DEFAULT_CONFIGURATION;                                    //                                  //
+              _Devices[_DeviceCount].maskEnable    = 0;                       // No alerts after the reset        //
+              _Devices[_DeviceCount].alertLimit    = 0;                       //                                  //
               _DeviceCount++;                                                 // Increment the device counter     //
-            } // of if-then the values will fit into EEPROM                   //                                  //
+            } // of if-then the values will fit into the table                //                                  //
           } // of if-then we have identified a INA226                         //                                  //
         } // of if-then we have identified a INA226 manufacturer code         //                                  //
       } // of if-then we have found a live device                             //                                  //
     } // for-next each possible I2C address                                   //                                  //
   } // of if-then first call with no devices found                            //                                  //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values for device    //
-  ina.current_LSB = (uint64_t)maxBusAmps*1000000000/32767;                    // Get the best possible LSB in nA  //
-  ina.calibration = (uint64_t)51200000 / ((uint64_t)ina.current_LSB *         // Compute calibration register     //
-                    (uint64_t)microOhmR / (uint64_t)100000);                  // using 64 bit numbers throughout  //
-  ina.power_LSB   = (uint32_t)25*ina.current_LSB;                             // Fixed multiplier for INA219      //
-  #ifdef debug_Mode                                                           // Display values when debugging    //
-  Serial.print(F("current_LSB = ")); Serial.println(ina.current_LSB);         //                                  //
-  Serial.print(F("calibration = ")); Serial.println(ina.calibration);         //                                  //
-  Serial.print(F("power_LSB   = ")); Serial.println(ina.power_LSB);           //                                  //
-  #endif                                                                      // end of conditional compile code  //
-  if (deviceNumber==UINT8_MAX) {                                              // If default value, then set all   //
-    for(uint8_t i=0;i<_DeviceCount;i++) {                                     // For each device write data       //
-      EEPROM.put(i*sizeof(ina),ina);                                          // Write value to address           //
-      writeWord(INA_CALIBRATION_REGISTER,ina.calibration,ina.address);        // Write the calibration value      //
-    } // of for each device                                                   //                                  //
-  } else {                                                                    //                                  //
-    EEPROM.put((deviceNumber%_DeviceCount)*sizeof(ina),ina);                  // Write struct, cater for overflow //
-    writeWord(INA_CALIBRATION_REGISTER,ina.calibration,ina.address);          // Write the calibration value      //
-  } // of if-then-else set one or all devices                                 //                                  //
+  if (_DeviceCount==0) return 0;                                              // Nothing to configure             //
+  for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
+    if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
+      _Devices[i].current_LSB = calibrated.current_LSB;                       // Store computed values in table   //
+      _Devices[i].calibration = calibrated.calibration;                       //                                  //
+      _Devices[i].power_LSB   = calibrated.power_LSB;                         //                                  //
+      writeWord(INA_CALIBRATION_REGISTER,calibrated.calibration,              // Write the calibration value      //
+                _Devices[i].address);                                         //                                  //
+    } // of if this device needs to be set                                    //                                  //
+  } // for-next each device loop                                              //                                  //
   return _DeviceCount;                                                        // Return number of devices found   //
+} // of method beginDevices()                                                 //                                  //
+/*******************************************************************************************************************
+** INA226_WireTransport class constructor                                                                         **
+*******************************************************************************************************************/
+INA226_WireTransport::INA226_WireTransport(TwoWire &wire,                     // Class constructor                //
+                                           const bool beginWire) :            //                                  //
+  _Wire(wire), _BeginWire(beginWire) {}                                       //                                  //
+/*******************************************************************************************************************
+** Method begin starts the bus on the first call, unless the sketch does that itself, and sets the clock if one   **
+** was chosen. The clock is set afterwards as TwoWire::begin() resets it on some boards.                          **
+*******************************************************************************************************************/
+void INA226_WireTransport::begin() {                                          // Start the bus if needed          //
+  if (!_Started && _BeginWire) _Wire.begin();                                 // Only once per transport          //
+  _Started = true;                                                            //                                  //
+  if (_ClockHz!=0) _Wire.setClock(_ClockHz);                                  //                                  //
 } // of method begin()                                                        //                                  //
 /*******************************************************************************************************************
+** Method setClock sets the bus clock, e.g. INA_I2C_FAST_PLUS, and leaves HS-mode                                 **
+*******************************************************************************************************************/
+void INA226_WireTransport::setClock(const uint32_t clockHz) {                 // Standard, fast or FM+ clock      //
+  _ClockHz         = clockHz;                                                 //                                  //
+  _HighSpeedHz     = 0;                                                       //                                  //
+  _HighSpeedActive = false;                                                   //                                  //
+  if (_Started) _Wire.setClock(clockHz);                                      //                                  //
+} // of method setClock()                                                     //                                  //
+/*******************************************************************************************************************
+** Method setHighSpeed selects HS-mode with the given clock for all following transactions, 0 leaves HS-mode      **
+*******************************************************************************************************************/
+void INA226_WireTransport::setHighSpeed(const uint32_t clockHz) {             // HS-mode clock, 0 to leave it     //
+  if (clockHz==0) setClock(_ClockHz==0 ? INA_I2C_FAST : _ClockHz);            // Back to the previous clock       //
+  _HighSpeedHz     = clockHz;                                                 //                                  //
+  _HighSpeedActive = false;                                                   //                                  //
+} // of method setHighSpeed()                                                 //                                  //
+/*******************************************************************************************************************
+** Method enterHighSpeed sends the HS master code at 400kHz without a stop condition and switches to the high     **
+** speed clock. No device acknowledges the master code, that's expected. The devices stay in HS-mode until the    **
+** next stop condition, so nothing is sent while a transaction is held for a repeated start.                      **
+*******************************************************************************************************************/
+void INA226_WireTransport::enterHighSpeed() {                                 // Send the HS master code          //
+  if (_HighSpeedHz==0 || _HighSpeedActive) return;                            // Not needed                       //
+  _Wire.setClock(INA_I2C_FAST);                                               // Master code in fast-mode         //
+  _Wire.beginTransmission(INA_HS_MASTER_CODE);                                //                                  //
+  _Wire.endTransmission(false);                                               // NACK, keep the bus               //
+  _Wire.setClock(_HighSpeedHz);                                               //                                  //
+  _HighSpeedActive = true;                                                    //                                  //
+} // of method enterHighSpeed()                                               //                                  //
+/*******************************************************************************************************************
+** Method write sends the bytes to a device and returns the status of Wire.endTransmission()                      **
+*******************************************************************************************************************/
+uint8_t INA226_WireTransport::write(const uint8_t deviceAddress,              // Write bytes to a device          //
+                                    const uint8_t *data, const uint8_t size,  //                                  //
+                                    const bool sendStop) {                    //                                  //
+  enterHighSpeed();                                                           // Only in HS-mode                  //
+  _Wire.beginTransmission(deviceAddress);                                     // Address the I2C device           //
+  for(uint8_t i=0;i<size;i++) _Wire.write(data[i]);                           // Queue the bytes                  //
+  uint8_t status = _Wire.endTransmission(sendStop);                           // Close or hold the transmission   //
+  if (sendStop || status!=0) _HighSpeedActive = false;                        // Stop ends HS-mode                //
+  return status;                                                              //                                  //
+} // of method write()                                                        //                                  //
+/*******************************************************************************************************************
+** Method read requests bytes from a device and returns the number received, stopping at a -1 from Wire.read()    **
+*******************************************************************************************************************/
+uint8_t INA226_WireTransport::read(const uint8_t deviceAddress,               // Read bytes from a device         //
+                                   uint8_t *data, const uint8_t size) {       //                                  //
+  enterHighSpeed();                                                           // Only in HS-mode                  //
+  uint8_t received = _Wire.requestFrom(deviceAddress,size);                   // Ends with a stop condition       //
+  _HighSpeedActive = false;                                                   //                                  //
+  for(uint8_t i=0;i<received;i++) {                                           //                                  //
+    int value = _Wire.read();                                                 // -1 if nothing is left            //
+    if (value<0) return i;                                                    //                                  //
+    data[i] = value;                                                          //                                  //
+  } // of for-next each byte                                                  //                                  //
+  return received;                                                            //                                  //
+} // of method read()                                                         //                                  //
+/*******************************************************************************************************************
+** Method setPointer writes the register pointer of a device unless the device is known to already point to that  **
+** register. The INA226 keeps its pointer between reads, so repeatedly reading the same register only needs the   **
+** read phase of the transfer. The pointer of each device is cached by the lower 4 bits of its I2C address and is **
+** forgotten whenever a transmission fails. When "repeatedStart" is set the bus is not released after writing the **
+** pointer, so the following read is part of the same transaction and no sync delay is needed.                    **
+*******************************************************************************************************************/
+void INA226_Class::setPointer(const uint8_t addr, const uint8_t deviceAddr,   // Select the register to be read   //
+                              const bool repeatedStart) {                     //                                  //
+  uint8_t &registerPointer = _RegisterPointer[deviceAddr&0x0F];               // Cached pointer for the device    //
+  if (registerPointer==addr && addr!=INA_UNKNOWN_POINTER) {                   // Already pointing to register     //
+    _TransmissionStatus = 0;                                                  // so nothing can have failed       //
+    return;                                                                   //                                  //
+  } // of if-then pointer already set                                         //                                  //
+  _TransmissionStatus = _Transport->write(deviceAddr,&addr,1,!repeatedStart); // Close or hold the transmission   //
+  INA_COUNT_TRANSFER(deviceAddr,addr,2,_TransmissionStatus,repeatedStart);    // Address and pointer bytes        //
+  registerPointer = _TransmissionStatus==0 ? addr : INA_UNKNOWN_POINTER;      // Remember pointer if successful   //
+  if (!repeatedStart) delayMicroseconds(I2C_DELAY);                           // delay required for sync          //
+} // of method setPointer()                                                   //                                  //
+/*******************************************************************************************************************
 ** Method readByte reads 1 byte from the specified address                                                        **
 *******************************************************************************************************************/
 uint8_t INA226_Class::readByte(const uint8_t addr,const uint8_t deviceAddr){  //                                  //
-  Wire.beginTransmission(deviceAddr);                                         // Address the I2C device           //
-  Wire.write(addr);                                                           // Send the register address to read//
-  _TransmissionStatus = Wire.endTransmission();                               // Close transmission               //
-  delayMicroseconds(I2C_DELAY);                                               // delay required for sync          //
-  Wire.requestFrom(deviceAddr, (uint8_t)1);                                   // Request 1 byte of data           //
-  return Wire.read();                                                         // read it and return it            //
+  setPointer(addr,deviceAddr);                                                // Send register address if needed  //
+  uint8_t data;                                                               // Byte read                        //
+  uint8_t received = _Transport->read(deviceAddr,&data,1);                    // Request 1 byte of data           //
+  if (received!=1) {                                                          // On failure the pointer is        //
+    _RegisterPointer[deviceAddr&0x0F] = INA_UNKNOWN_POINTER;                  // unknown, the read counts as an   //
+    _TransmissionStatus = received==0 ? 2 : 4;                                // address NACK or other error      //
+    INA_COUNT_TRANSFER(deviceAddr,addr,0,_TransmissionStatus,false);          //                                  //
+    return 0;                                                                 //                                  //
+  } // of if-then read failed                                                 //                                  //
+  INA_COUNT_TRANSFER(deviceAddr,addr,2,0,false);                              // Address and data byte            //
+  return data;                                                                //                                  //
 } // of method readByte()                                                     //                                  //
 /*******************************************************************************************************************
-** Method readWord reads 2 bytes from the specified address                                                       **
-*******************************************************************************************************************/
-int16_t INA226_Class::readWord(const uint8_t addr,const uint8_t deviceAddr){  //                                  //
-  int16_t returnData;                                                         // Store return value               //
-  Wire.beginTransmission(deviceAddr);                                         // Address the I2C device           //
-  Wire.write(addr);                                                           // Send the register address to read//
-  _TransmissionStatus = Wire.endTransmission();                               // Close transmission               //
-  delayMicroseconds(I2C_DELAY);                                               // delay required for sync          //
-  Wire.requestFrom(deviceAddr, (uint8_t)2);                                   // Request 2 consecutive bytes      //
-  returnData = Wire.read();                                                   // Read the msb                     //
-  returnData = returnData<<8;                                                 // shift the data over              //
-  returnData|= Wire.read();                                                   // Read the lsb                     //
-  return returnData;                                                          // read it and return it            //
+** Method readWord reads 2 bytes from the specified address. If fewer bytes are received, e.g. because            **
+** Wire.read() returned -1, the status is set and 0 is returned.                                                  **
+*******************************************************************************************************************/
+int16_t INA226_Class::readWord(const uint8_t addr,const uint8_t deviceAddr,   //                                  //
+                              const bool repeatedStart) {                     //                                  //
+  setPointer(addr,deviceAddr,repeatedStart);                                  // Send register address if needed  //
+  uint8_t data[2];                                                            // msb and lsb                      //
+  uint8_t received = _Transport->read(deviceAddr,data,2);                     // Request 2 consecutive bytes      //
+  if (received!=2) {                                                          // On failure the pointer is        //
+    _RegisterPointer[deviceAddr&0x0F] = INA_UNKNOWN_POINTER;                  // unknown, the read counts as an   //
+    _TransmissionStatus = received==0 ? 2 : 4;                                // address NACK or other error and  //
+    INA_COUNT_TRANSFER(deviceAddr,addr,0,_TransmissionStatus,false);          // 0 is returned instead of         //
+    return 0;                                                                 // partial data                     //
+  } // of if-then read failed                                                 //                                  //
+  INA_COUNT_TRANSFER(deviceAddr,addr,3,0,false);                              // Address and data bytes           //
+  return data[0]<<8|data[1];                                                  // Combine the bytes                //
 } // of method readWord()                                                     //                                  //
 /*******************************************************************************************************************
 ** Method writeByte write 1 byte to the specified address                                                         **
 *******************************************************************************************************************/
 void INA226_Class::writeByte(const uint8_t addr, const uint8_t data,          //                                  //
                              const uint8_t deviceAddr) {                      //                                  //
-  Wire.beginTransmission(deviceAddr);                                         // Address the I2C device           //
-  Wire.write(addr);                                                           // Send register address to write   //
-  Wire.write(data);                                                           // Send the data to write           //
-  _TransmissionStatus = Wire.endTransmission();                               // Close transmission               //
+  const uint8_t buffer[2] = {addr,data};                                      // Register address and data        //
+  _TransmissionStatus = _Transport->write(deviceAddr,buffer,2,true);          // Write and close transmission     //
+  INA_COUNT_TRANSFER(deviceAddr,addr,3,_TransmissionStatus,false);            // Address, pointer and data        //
+  _RegisterPointer[deviceAddr&0x0F] =                                         // A write also sets the pointer    //
+    _TransmissionStatus==0 ? addr : INA_UNKNOWN_POINTER;                      // unless the write failed          //
 } // of method writeByte()                                                    //                                  //
 /*******************************************************************************************************************
 ** Method writeWord writes 2 byte to the specified address                                                        **
 *******************************************************************************************************************/
 void INA226_Class::writeWord(const uint8_t addr, const uint16_t data,         //                                  //
                             const uint8_t deviceAddr) {                       //                                  //
-  Wire.beginTransmission(deviceAddr);                                         // Address the I2C device           //
-  Wire.write(addr);                                                           // Send register address to write   //
-  Wire.write((uint8_t)(data>>8));                                             // Write the first byte             //
-  Wire.write((uint8_t)data);                                                  // and then the second              //
-  _TransmissionStatus = Wire.endTransmission();                               // Close transmission               //
+  const uint8_t buffer[3] = {addr,(uint8_t)(data>>8),(uint8_t)data};          // Register address, msb and lsb    //
+  _TransmissionStatus = _Transport->write(deviceAddr,buffer,3,true);          // Write and close transmission     //
+  INA_COUNT_TRANSFER(deviceAddr,addr,4,_TransmissionStatus,false);            // Address, pointer and data        //
+  _RegisterPointer[deviceAddr&0x0F] =                                         // A write also sets the pointer    //
+    _TransmissionStatus==0 ? addr : INA_UNKNOWN_POINTER;                      // unless the write failed          //
 } // of method writeWord()                                                    //                                  //
 /*******************************************************************************************************************
+** Method getTransmissionStatus returns the status of the last I2C transfer, 0 if it succeeded. The codes are     **
+** those of Wire.endTransmission(), 2 is also returned when a read wasn't acknowledged and 4 when it returned too **
+** few bytes, in which case the register read as 0.                                                               **
+*******************************************************************************************************************/
+uint8_t INA226_Class::getTransmissionStatus() {                               // Status of the last I2C transfer  //
+  return _TransmissionStatus;                                                 //                                  //
+} // of method getTransmissionStatus()                                        //                                  //
+#ifdef INA_INSTRUMENTATION                                                    // Only when instrumented           //
+/*******************************************************************************************************************
+** Method countTransfer counts one I2C transfer for the device address and register. Bytes are only counted for   **
+** transfers which succeeded. Status 2 and 3 are NACKs of the address or data and 5 a bus timeout, as returned by **
+** the newer Wire libraries. A transaction runs from START to STOP, so when the previous transfer held the bus    **
+** with a repeated start, e.g. a pointer write followed by a read, this transfer doesn't start a new one.         **
+*******************************************************************************************************************/
+void INA226_Class::countTransfer(const uint8_t deviceAddr, const uint8_t addr,// Count one I2C transaction        //
+                                 const uint8_t bytes, const uint8_t status,   //                                  //
+                                 const bool hold) {                           //                                  //
+  inaBusCounters *counters[2] = {&_DeviceCounters[deviceAddr&0x0F],           // Count for the device and for the //
+    &_RegisterCounters[addr<INA_REGISTER_SLOTS-1 ? addr : INA_REGISTER_SLOTS-1]};// register, ID ones share one   //
+  for(uint8_t i=0;i<2;i++) {                                                  //                                  //
+    if (!_BusHeld) counters[i]->transactions++;                               // Repeated start continues one     //
+    if      (status==0)              counters[i]->bytes += bytes;             //                                  //
+    else if (status==2 || status==3) counters[i]->nacks++;                    //                                  //
+    else if (status==5)              counters[i]->timeouts++;                 //                                  //
+    else                             counters[i]->errors++;                   //                                  //
+  } // of for-next device and register                                        //                                  //
+  _BusHeld = hold && status==0;                                               // Next transfer continues this one //
+} // of method countTransfer()                                                //                                  //
+/*******************************************************************************************************************
+** Method getBusCounters returns the I2C traffic counters of a device                                             **
+*******************************************************************************************************************/
+void INA226_Class::getBusCounters(const uint8_t deviceNumber,                 // I2C traffic of a device          //
+                                  inaBusCounters &counters) {                 //                                  //
+  counters = _DeviceCounters[_Devices[deviceNumber%_DeviceCount].address&0x0F];//                                 //
+} // of method getBusCounters()                                               //                                  //
+/*******************************************************************************************************************
+** Method getRegisterCounters returns the I2C traffic counters of a register, summed over all devices. Registers  **
+** above the alert limit register, i.e. the ID registers, are counted together.                                   **
+*******************************************************************************************************************/
+void INA226_Class::getRegisterCounters(const uint8_t registerAddress,         // I2C traffic of a register        //
+                                       inaBusCounters &counters) {            //                                  //
+  counters = _RegisterCounters[registerAddress<INA_REGISTER_SLOTS-1 ?         //                                  //
+                               registerAddress : INA_REGISTER_SLOTS-1];       //                                  //
+} // of method getRegisterCounters()                                          //                                  //
+/*******************************************************************************************************************
+** Method getHistogram returns the duration histogram of an API group, one of the INA_API_ constants              **
+*******************************************************************************************************************/
+void INA226_Class::getHistogram(const uint8_t api, inaHistogram &histogram) { // Durations of an API group        //
+  histogram = _Histograms[api%INA_API_COUNT];                                 //                                  //
+} // of method getHistogram()                                                 //                                  //
+/*******************************************************************************************************************
+** Method resetInstrumentation clears all counters and histograms                                                 **
+*******************************************************************************************************************/
+void INA226_Class::resetInstrumentation() {                                   // Clear counters and histograms    //
+  memset(_DeviceCounters,0,sizeof(_DeviceCounters));                          //                                  //
+  memset(_RegisterCounters,0,sizeof(_RegisterCounters));                      //                                  //
+  memset(_Histograms,0,sizeof(_Histograms));                                  //                                  //
+  _BusHeld = false;                                                           //                                  //
+} // of method resetInstrumentation()                                         //                                  //
+#endif                                                                        // of if-then instrumentation       //
+/*******************************************************************************************************************
 ** Method getBusMilliVolts retrieves the bus voltage measurement                                                  **
 *******************************************************************************************************************/
 uint16_t INA226_Class::getBusMilliVolts(const bool waitSwitch,                //                                  //
                                         const uint8_t deviceNumber) {         //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
-  if (waitSwitch) waitForConversion();                                        // wait for conversion to complete  //
+  INA_TIME_API(INA_API_BUS);                                                  //                                  //
+  const inaDet &ina = _Devices[deviceNumber%_DeviceCount];                    // Reference device table entry     //
+  if (waitSwitch) waitForConversion(deviceNumber);                            // wait for conversion to complete  //
   uint16_t busVoltage = readWord(INA_BUS_VOLTAGE_REGISTER,ina.address);       // Get the raw value and apply      //
-  busVoltage = (uint32_t)busVoltage*INA_BUS_VOLTAGE_LSB/100;                  // conversion to get milliVolts     //
-  if (!bitRead(ina.operatingMode,2) && bitRead(ina.operatingMode,1)) {        // If triggered mode and bus active //
-    int16_t configRegister = readWord(INA_CONFIGURATION_REGISTER,ina.address);// Get the current register         //
-    writeWord(INA_CONFIGURATION_REGISTER,configRegister,ina.address);         // Write back to trigger next       //
-  } // of if-then triggered mode enabled                                      //                                  //
+  busVoltage = busToMilliVolts(busVoltage);                                   // conversion to get milliVolts     //
+  if (!bitRead(ina.operatingMode,2) && bitRead(ina.operatingMode,1))          // If triggered mode and bus active //
+    writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address);      // write the shadow to trigger next //
   return(busVoltage);                                                         // return computed milliVolts       //
 } // of method getBusMilliVolts()                                             //                                  //
 /*******************************************************************************************************************
@@ -137,79 +404,136 @@ uint16_t INA226_Class::getBusMilliVolts(const bool waitSwitch,                //
 *******************************************************************************************************************/
 int16_t INA226_Class::getShuntMicroVolts(const bool waitSwitch,               //                                  //
                                          const uint8_t deviceNumber) {        //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
-  if (waitSwitch) waitForConversion();                                        // wait for conversion to complete  //
+  INA_TIME_API(INA_API_SHUNT);                                                //                                  //
+  const inaDet &ina = _Devices[deviceNumber%_DeviceCount];                    // Reference device table entry     //
+  if (waitSwitch) waitForConversion(deviceNumber);                            // wait for conversion to complete  //
   int32_t shuntVoltage = readWord(INA_SHUNT_VOLTAGE_REGISTER,ina.address);    // Get the raw value                //
-Serial.print("shuntVoltageRaw = ");Serial.println(shuntVoltage);
-  shuntVoltage = shuntVoltage*INA_SHUNT_VOLTAGE_LSB/10;                       // Convert to microvolts            //
-  if (!bitRead(ina.operatingMode,2) && bitRead(ina.operatingMode,0)) {        // If triggered and shunt active    //
-    int16_t configRegister = readWord(INA_CONFIGURATION_REGISTER,ina.address);// Get the current register         //
-    writeWord(INA_CONFIGURATION_REGISTER,configRegister,ina.address);         // Write back to trigger next       //
-  } // of if-then triggered mode enabled                                      //                                  //
+  #ifdef debug_Mode                                                           // Display values when debugging    //
+  Serial.print(F("shuntVoltageRaw = ")); Serial.println(shuntVoltage);        //                                  //
+  #endif                                                                      // end of conditional compile code  //
+  shuntVoltage = shuntToMicroVolts(shuntVoltage);                             // Convert to microvolts            //
+  if (!bitRead(ina.operatingMode,2) && bitRead(ina.operatingMode,0))          // If triggered and shunt active    //
+    writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address);      // write the shadow to trigger next //
   return((int16_t)shuntVoltage);                                              // return computed microvolts       //
 } // of method getShuntMicroVolts()                                           //                                  //
 /*******************************************************************************************************************
 ** Method getBusMicroAmps retrieves the computed current in microamps.                                            **
 *******************************************************************************************************************/
 int32_t INA226_Class::getBusMicroAmps(const uint8_t deviceNumber) {           //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
+  INA_TIME_API(INA_API_CURRENT);                                              //                                  //
+  const inaDet &ina = _Devices[deviceNumber%_DeviceCount];                    // Reference device table entry     //
   int32_t microAmps = readWord(INA_CURRENT_REGISTER,ina.address);             // Get the raw value                //
-
-Serial.print("BusCurrentRaw = ");Serial.println(microAmps);
-          microAmps = (int64_t)microAmps*ina.current_LSB/100000;                // Convert to microamps             //
+  #ifdef debug_Mode                                                           // Display values when debugging    //
+  Serial.print(F("BusCurrentRaw = ")); Serial.println(microAmps);             //                                  //
+  #endif                                                                      // end of conditional compile code  //
+  microAmps = currentToMicroAmps(microAmps,ina);                              // Convert to microamps             //
   return(microAmps);                                                          // return computed microamps        //
 } // of method getBusMicroAmps()                                              //                                  //
 /*******************************************************************************************************************
 ** Method getBusMicroWatts retrieves the computed power in milliwatts                                             **
 *******************************************************************************************************************/
 int32_t INA226_Class::getBusMicroWatts(const uint8_t deviceNumber) {          //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
+  INA_TIME_API(INA_API_POWER);                                                //                                  //
+  const inaDet &ina = _Devices[deviceNumber%_DeviceCount];                    // Reference device table entry     //
   int32_t microWatts = readWord(INA_POWER_REGISTER,ina.address);              // Get the raw value                //
-          microWatts = (int64_t)microWatts*ina.power_LSB/1000;                // Convert to milliwatts            //
+  microWatts = powerToMicroWatts(microWatts,ina);                             // Convert to microwatts            //
   return(microWatts);                                                         // return computed milliwatts       //
 } // of method getBusMicroWatts()                                             //                                  //
 /*******************************************************************************************************************
+** Method readSnapshot reads the shunt voltage, bus voltage, current and power registers of one device in one     **
+** burst using readResults() and converts them to engineering units once, after all the registers have been read. **
+*******************************************************************************************************************/
+void INA226_Class::readSnapshot(const uint8_t deviceNumber,                   // Read all results in one burst    //
+                                inaSnapshot &snapshot) {                      //                                  //
+  INA_TIME_API(INA_API_SNAPSHOT);                                             //                                  //
+  const inaDet &ina = _Devices[deviceNumber%_DeviceCount];                    // Reference device table entry     //
+  inaRawSample  raw;                                                          // Raw register values              //
+  snapshot.conversionReady = readResults(ina,raw);                            // Read all result registers        //
+  snapshot.timestamp       = raw.timestamp;                                   //                                  //
+  snapshot.busMilliVolts   = busToMilliVolts(raw.bus);                        // Convert to engineering units     //
+  snapshot.shuntMicroVolts = shuntToMicroVolts(raw.shunt);                    //                                  //
+  snapshot.busMicroAmps    = currentToMicroAmps(raw.current,ina);             //                                  //
+  snapshot.busMicroWatts   = powerToMicroWatts(raw.power,ina);                //                                  //
+} // of method readSnapshot()                                                 //                                  //
+/*******************************************************************************************************************
+** Method readResults reads the four result registers of a device, each register read being one transaction using **
+** a repeated start. The mask/enable register is read first which returns and clears the conversion ready flag,   **
+** and once more after the results. Should a conversion have finished while the results were being read then they **
+** are read again, so the four values always come from the same conversion. Returns the conversion ready flag. If **
+** "onlyIfReady" is set and no conversion has finished then nothing else is read.                                 **
+*******************************************************************************************************************/
+bool INA226_Class::readResults(const inaDet &ina, inaRawSample &raw,          // Read all result registers        //
+                               const bool onlyIfReady) {                      //                                  //
+  bool conversionReady = readMask(ina,true)&                                  // Read and clear the conversion    //
+                         INA_CONVERSION_READY_MASK;                           // ready flag                       //
+  if (onlyIfReady && !conversionReady) return false;                          // Leave "raw" unchanged            //
+  for(uint8_t attempt=0;attempt<2;attempt++) {                                // Read again if a conversion ends  //
+    raw.timestamp = micros();                                                 // Time of the reading              //
+    raw.shunt     = readWord(INA_SHUNT_VOLTAGE_REGISTER,ina.address,true);    // Read all result registers        //
+    raw.bus       = readWord(INA_BUS_VOLTAGE_REGISTER,ina.address,true);      //                                  //
+    raw.power     = readWord(INA_POWER_REGISTER,ina.address,true);            //                                  //
+    raw.current   = readWord(INA_CURRENT_REGISTER,ina.address,true);          //                                  //
+    if (attempt>0 || !(readMask(ina,true)&                                    // Done unless a conversion has     //
+        INA_CONVERSION_READY_MASK)) break;                                    // completed during the burst       //
+    conversionReady = true;                                                   // Newer results are available      //
+  } // of for-next each attempt                                               //                                  //
+  return conversionReady;                                                     //                                  //
+} // of method readResults()                                                  //                                  //
+/*******************************************************************************************************************
+** Methods busToMilliVolts, shuntToMicroVolts, currentToMicroAmps and powerToMicroWatts convert the raw contents  **
+** of the result registers to engineering units using the fixed voltage LSBs and the device's current/power LSBs. **
+** They are static so that the telemetry decoder in extras/host converts with the same arithmetic.                **
+*******************************************************************************************************************/
+uint16_t INA226_Class::busToMilliVolts(const uint16_t busRaw) {               // Convert bus voltage register     //
+  return (uint32_t)busRaw*INA_BUS_VOLTAGE_LSB/100;                            //                                  //
+} // of method busToMilliVolts()                                              //                                  //
+int32_t INA226_Class::shuntToMicroVolts(const int16_t shuntRaw) {             // Convert shunt voltage register   //
+  return (int32_t)shuntRaw*INA_SHUNT_VOLTAGE_LSB/10;                          //                                  //
+} // of method shuntToMicroVolts()                                            //                                  //
+int32_t INA226_Class::currentToMicroAmps(const int16_t currentRaw,            // Convert current register         //
+                                         const inaDet &ina) {                 //                                  //
+  return (int64_t)currentRaw*ina.current_LSB/1000;                            // LSB is in nA                     //
+} // of method currentToMicroAmps()                                           //                                  //
+int32_t INA226_Class::powerToMicroWatts(const uint16_t powerRaw,              // Convert power register           //
+                                        const inaDet &ina) {                  //                                  //
+  return (int64_t)powerRaw*ina.power_LSB/1000;                                //                                  //
+} // of method powerToMicroWatts()                                            //                                  //
+/*******************************************************************************************************************
 ** Method reset resets the INA226 using the first bit in the configuration register                               **
 *******************************************************************************************************************/
 void INA226_Class::reset(const uint8_t deviceNumber) {                        // Reset the INA226                 //
-  inaDet ina;                                                                 // Hold device details in structure //
-  int16_t configRegister;                                                     // Hold configuration register      //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      EEPROM.get(i*sizeof(ina),ina);                                          // Read EEPROM values               //
-      writeWord(INA_CONFIGURATION_REGISTER,0x8000,ina.address);               // Set most significant bit         //
+      writeWord(INA_CONFIGURATION_REGISTER,0x8000,_Devices[i].address);       // Set most significant bit         //
       delay(I2C_DELAY);                                                       // Let the INA226 reboot            //
+      _Devices[i].operatingMode = B111;                                       // The registers now hold their     //
+      _Devices[i].configuration = INA_DEFAULT_CONFIGURATION;                  // power-on values                  //
+      _Devices[i].maskEnable    = 0;                                          //                                  //
+      _Devices[i].alertLimit    = 0;                                          //                                  //
+      _AlertPending[i]          = 0;                                          // and no flags are set             //
+      bitClear(_ConfigPending,i);                                             // Nothing left to write            //
+      bitClear(_MaskPending,i);                                               //                                  //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
 } // of method reset                                                          //                                  //
 /*******************************************************************************************************************
-** Method getMode returns the current monitoring mode of the device selected                                      **
+** Method getMode returns the current monitoring mode of the device selected, the first device by default         **
 *******************************************************************************************************************/
 uint8_t INA226_Class::getMode(const uint8_t deviceNumber ) {                  // Return the monitoring mode       //
-  inaDet ina;                                                                 // Hold device details in structure //
-  uint8_t tempDevice = deviceNumber+1;                                        // Temporary device number storage  //
-  EEPROM.get(tempDevice*sizeof(ina),ina);                                     // Read EEPROM values               //
-  return(ina.operatingMode);                                                  // Return stored value              //
+  uint8_t device = deviceNumber==UINT8_MAX ? 0 : deviceNumber%_DeviceCount;   // Default is the first device      //
+  return(_Devices[device].operatingMode);                                     // Return stored value              //
 } // of method getMode()                                                      //                                  //
 /*******************************************************************************************************************
 ** Method setMode allows the various mode combinations to be set. If no parameter is given the system goes back   **
 ** to the default startup mode.                                                                                   **
 *******************************************************************************************************************/
 void INA226_Class::setMode(const uint8_t mode,const uint8_t deviceNumber ) {  // Set the monitoring mode          //
-  inaDet ina;                                                                 // Hold device details in structure //
-  int16_t configRegister;                                                     // Hold configuration register      //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      EEPROM.get(i*sizeof(ina),ina);                                          // Read EEPROM values               //
-      configRegister = readWord(INA_CONFIGURATION_REGISTER,ina.address);      // Get the current register         //
-      configRegister &= ~INA_CONFIG_MODE_MASK;                                // zero out the mode bits           //
-      ina.operatingMode = B00001111 & mode;                                   // Mask off unused bits             //
-      EEPROM.put((deviceNumber%_DeviceCount)*sizeof(ina),ina);                // Write new EEPROM values          //
-      configRegister |= ina.operatingMode;                                    // shift in the mode settings       //
-      writeWord(INA_CONFIGURATION_REGISTER,configRegister,ina.address);       // Save new value                   //
+      _Devices[i].operatingMode = B00001111 & mode;                           // Mask off unused bits             //
+      updateConfig(i,INA_CONFIG_MODE_MASK,mode&INA_CONFIG_MODE_MASK);         // Shift in the mode settings       //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
 } // of method setMode()                                                      //                                  //
@@ -218,24 +542,19 @@ void INA226_Class::setMode(const uint8_t mode,const uint8_t deviceNumber ) {  //
 *******************************************************************************************************************/
 void INA226_Class::setAveraging(const uint16_t averages,                      // Set the number of averages taken //
                                 const uint8_t deviceNumber ) {                //                                  //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
   uint8_t averageIndex;                                                       // Store indexed value for register //
-  int16_t configRegister;                                                     // Configuration register contents  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
+  if      (averages>=1024) averageIndex = 7;                                  // setting depending upon range     //
+  else if (averages>= 512) averageIndex = 6;                                  //                                  //
+  else if (averages>= 256) averageIndex = 5;                                  //                                  //
+  else if (averages>= 128) averageIndex = 4;                                  //                                  //
+  else if (averages>=  64) averageIndex = 3;                                  //                                  //
+  else if (averages>=  16) averageIndex = 2;                                  //                                  //
+  else if (averages>=   4) averageIndex = 1;                                  //                                  //
+  else                     averageIndex = 0;                                  //                                  //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      configRegister = readWord(INA_CONFIGURATION_REGISTER,ina.address);      // Get the current register         //
-      if      (averages>=1024) averageIndex = 7;                              // setting depending upon range     //
-      else if (averages>= 512) averageIndex = 6;                              //                                  //
-      else if (averages>= 256) averageIndex = 5;                              //                                  //
-      else if (averages>= 128) averageIndex = 4;                              //                                  //
-      else if (averages>=  64) averageIndex = 3;                              //                                  //
-      else if (averages>=  16) averageIndex = 2;                              //                                  //
-      else if (averages>=   4) averageIndex = 1;                              //                                  //
-      else                     averageIndex = 0;                              //                                  //
-      configRegister &= ~INA_CONFIG_AVG_MASK;                                 // zero out the averages part       //
-      configRegister |= (uint16_t)averageIndex << 9;                          // shift in the averages to register//
-      writeWord(INA_CONFIGURATION_REGISTER,configRegister,ina.address);       // Save new value                   //
+      updateConfig(i,INA_CONFIG_AVG_MASK,(uint16_t)averageIndex<<9);          // Shift in the averages            //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
 } // of method setAveraging()                                                 //                                  //
@@ -244,16 +563,11 @@ void INA226_Class::setAveraging(const uint16_t averages,                      //
 *******************************************************************************************************************/
 void INA226_Class::setBusConversion(uint8_t convTime,                         // Set timing for Bus conversions   //
                                     const uint8_t deviceNumber ) {            //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
-  int16_t configRegister;                                                     // Store configuration register     //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
+  if (convTime>7) convTime=7;                                                 // Use maximum value allowed        //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      if (convTime>7) convTime=7;                                             // Use maximum value allowed        //
-      configRegister = readWord(INA_CONFIGURATION_REGISTER,ina.address);      // Get the current register         //
-      configRegister &= ~INA_CONFIG_BUS_TIME_MASK;                            // zero out the Bus conversion part //
-      configRegister |= (uint16_t)convTime << 6;                              // shift in the averages to register//
-      writeWord(INA_CONFIGURATION_REGISTER,configRegister,ina.address);       // Save new value                   //
+      updateConfig(i,INA_CONFIG_BUS_TIME_MASK,(uint16_t)convTime<<6);         // Shift in the conversion time     //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
 } // of method setBusConversion()                                             //                                  //
@@ -262,51 +576,1148 @@ void INA226_Class::setBusConversion(uint8_t convTime,                         //
 *******************************************************************************************************************/
 void INA226_Class::setShuntConversion(uint8_t convTime,                       // Set timing for Bus conversions   //
                                       const uint8_t deviceNumber ) {          //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
-  int16_t configRegister;                                                     // Store configuration register     //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
+  if (convTime>7) convTime=7;                                                 // Use maximum value allowed        //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      if (convTime>7) convTime=7;                                             // Use maximum value allowed        //
-      configRegister = readWord(INA_CONFIGURATION_REGISTER,ina.address);      // Get the current register         //
-      configRegister &= ~INA_CONFIG_SHUNT_TIME_MASK;                          // zero out the Bus conversion part //
-      configRegister |= (uint16_t)convTime << 3;                              // shift in the averages to register//
-      writeWord(INA_CONFIGURATION_REGISTER,configRegister,ina.address);       // Save new value                   //
+      updateConfig(i,INA_CONFIG_SHUNT_TIME_MASK,(uint16_t)convTime<<3);       // Shift in the conversion time     //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
 } // of method setShuntConversion()                                           //                                  //
 /*******************************************************************************************************************
+** Method setAlertLimit arms one of the limit functions of the ALERT pin, INA_ALERT_SHUNT_OVER or _UNDER with the **
+** limit given as a current in mA, INA_ALERT_BUS_OVER or _UNDER in mV or INA_ALERT_POWER_OVER in mW, or disarms   **
+** them with INA_ALERT_NONE. A current limit compares with getBusMicroAmps()/1000 and a power limit with          **
+** getBusMicroWatts()/1000. The limit is converted to register units using each device's calibration and LSBs and **
+** the alert limit register is written at once, the mask/enable register follows beginConfig()/commit(). The      **
+** device supports one limit function at a time, besides the conversion ready alert.                              **
+*******************************************************************************************************************/
+void INA226_Class::setAlertLimit(const uint16_t alertFunction,                // Arm a limit function with the    //
+                                 const int32_t  limit,                        // limit in mA, mV or mW            //
+                                 const uint8_t  deviceNumber) {               //                                  //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
+  for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
+    if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
+      inaDet &ina    = _Devices[i];                                           // Reference device table entry     //
+      ina.alertLimit = alertLimitRaw(alertFunction,limit,ina);                // Convert to register units        //
+      writeWord(INA_ALERT_LIMIT_REGISTER,ina.alertLimit,ina.address);         //                                  //
+      updateMask(i,INA_ALERT_FUNCTION_MASK,                                   // Select the limit function        //
+                 alertFunction&INA_ALERT_FUNCTION_MASK);                      //                                  //
+    } // of if this device needs to be set                                    //                                  //
+  } // for-next each device loop                                              //                                  //
+} // of method setAlertLimit()                                                //                                  //
+/*******************************************************************************************************************
+** Method alertLimitRaw converts a limit in engineering units to the alert limit register. Shunt limits compare   **
+** the shunt voltage, which is current*2048/calibration in current LSBs, bus limits are in 1.25mV and power       **
+** limits in power LSBs. The result is clamped to the range of the register being compared.                       **
+*******************************************************************************************************************/
+uint16_t INA226_Class::alertLimitRaw(const uint16_t alertFunction,            // Convert a limit to the register  //
+                                     const int32_t limit,                     //                                  //
+                                     const inaDet &ina) {                     //                                  //
+  int64_t limitRaw = 0;                                                       // Computed register value          //
+  if (alertFunction&(INA_ALERT_SHUNT_OVER|INA_ALERT_SHUNT_UNDER)) {           // Current limit in mA              //
+    limitRaw = (int64_t)limit*1000000*2048/                                   // to nA, then to shunt LSBs        //
+               ((int64_t)ina.current_LSB*ina.calibration);                    //                                  //
+    if (limitRaw>INT16_MAX) limitRaw = INT16_MAX;                             // Clamp to signed 16 bits          //
+    if (limitRaw<INT16_MIN) limitRaw = INT16_MIN;                             //                                  //
+  } else if (alertFunction&(INA_ALERT_BUS_OVER|INA_ALERT_BUS_UNDER)) {        // Bus limit in mV                  //
+    limitRaw = (int64_t)limit*100/INA_BUS_VOLTAGE_LSB;                        //                                  //
+    if (limitRaw>INT16_MAX) limitRaw = INT16_MAX;                             // Bus register is 15 bits          //
+    if (limitRaw<0)         limitRaw = 0;                                     //                                  //
+  } else if (alertFunction&INA_ALERT_POWER_OVER) {                            // Power limit in mW                //
+    limitRaw = (int64_t)limit*1000000/ina.power_LSB;                          // to nW, then to power LSBs        //
+    if (limitRaw>UINT16_MAX) limitRaw = UINT16_MAX;                           //                                  //
+    if (limitRaw<0)          limitRaw = 0;                                    //                                  //
+  } // of if-then-else alert function                                         //                                  //
+  return (uint16_t)limitRaw;                                                  //                                  //
+} // of method alertLimitRaw()                                                //                                  //
+/*******************************************************************************************************************
+** Method setAlertLatch selects whether the ALERT pin and alert function flag stay active after a limit has been  **
+** exceeded until getAlertFlags() reads them, or follow the measured values                                       **
+*******************************************************************************************************************/
+void INA226_Class::setAlertLatch(const bool latched,                          // Keep ALERT active until read     //
+                                 const uint8_t deviceNumber) {                //                                  //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
+  for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
+    if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
+      updateMask(i,INA_ALERT_LATCH,latched ? INA_ALERT_LATCH : 0);            //                                  //
+    } // of if this device needs to be set                                    //                                  //
+  } // for-next each device loop                                              //                                  //
+} // of method setAlertLatch()                                                //                                  //
+/*******************************************************************************************************************
+** Method getAlertFlags returns the limit function which tripped (INA_ALERT_SHUNT_OVER etc.),                     **
+** INA_ALERT_CONVERSION_READY if a conversion has finished and INA_ALERT_MATH_OVERFLOW, or 0. The mask/enable     **
+** register is read in a single transaction, which clears the conversion ready flag and a latched alert and so    **
+** releases the ALERT pin. As every other read of the register, e.g. by readSnapshot() or the Sampler, clears     **
+** them as well, the flags seen by all of them since the last call are returned too and then cleared.             **
+*******************************************************************************************************************/
+uint16_t INA226_Class::getAlertFlags(const uint8_t deviceNumber) {            // Read and clear tripped alerts    //
+  uint8_t       device = deviceNumber%_DeviceCount;                           // Index into the device table      //
+  const inaDet &ina    = _Devices[device];                                    // Reference device table entry     //
+  readMask(ina,true);                                                         // Read and clear the flags         //
+  uint16_t maskRegister;                                                      // Flags of all readers             //
+  {                                                                           // The Sampler adds flags from its  //
+    inaInterruptLock lock;                                                    // interrupt handler                //
+    maskRegister          = _AlertPending[device];                            //                                  //
+    _AlertPending[device] = 0;                                                //                                  //
+  } // of interrupt lock                                                      //                                  //
+  uint16_t alertFlags   = maskRegister&INA_ALERT_MATH_OVERFLOW;               //                                  //
+  if (maskRegister&INA_ALERT_FUNCTION_FLAG)                                   // The armed function tripped       //
+    alertFlags |= ina.maskEnable&INA_ALERT_FUNCTION_MASK;                     //                                  //
+  if (maskRegister&INA_CONVERSION_READY_MASK)                                 // A conversion has finished        //
+    alertFlags |= INA_ALERT_CONVERSION_READY;                                 //                                  //
+  return alertFlags;                                                          //                                  //
+} // of method getAlertFlags()                                                //                                  //
+/*******************************************************************************************************************
+** Method readMask reads the mask/enable register of a device. The read clears the conversion ready flag and a    **
+** latched alert function flag in the device, so these and the math overflow flag are kept for getAlertFlags().   **
+** All reads of the register go through this method.                                                              **
+*******************************************************************************************************************/
+uint16_t INA226_Class::readMask(const inaDet &ina,                            // Read mask/enable, keep the flags //
+                                const bool repeatedStart) {                   //                                  //
+  uint16_t maskRegister = readWord(INA_MASK_ENABLE_REGISTER,ina.address,      //                                  //
+                                   repeatedStart);                            //                                  //
+  if (_TransmissionStatus==0) {                                               // 0 is returned on failure         //
+    inaInterruptLock lock;                                                    // The 16-bit OR isn't atomic       //
+    _AlertPending[&ina-_Devices] |= maskRegister&(INA_ALERT_FUNCTION_FLAG|    //                                  //
+                                    INA_CONVERSION_READY_MASK|                //                                  //
+                                    INA_ALERT_MATH_OVERFLOW);                 //                                  //
+  } // of if-then read succeeded                                              //                                  //
+  return maskRegister;                                                        //                                  //
+} // of method readMask()                                                     //                                  //
+/*******************************************************************************************************************
+** Methods updateConfig and updateMask clear and set bits in the shadow of the configuration or mask/enable       **
+** register of one device. Outside of beginConfig()/commit() the register is written at once, which is the only   **
+** bus access a setter needs. Inside, the device is only marked and commit() writes each register once.           **
+*******************************************************************************************************************/
+void INA226_Class::updateConfig(const uint8_t device,                         // Change the shadow configuration  //
+                                const uint16_t clearBits,                     // and write or defer it            //
+                                const uint16_t setBits) {                     //                                  //
+  inaDet &ina = _Devices[device];                                             // Reference device table entry     //
+  ina.configuration = (ina.configuration&~clearBits)|setBits;                 //                                  //
+  if (_ConfigBatch) bitSet(_ConfigPending,device);                            // Written by commit()              //
+  else writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address);   // Write the new value              //
+} // of method updateConfig()                                                 //                                  //
+void INA226_Class::updateMask(const uint8_t device,                           // Change the shadow mask/enable    //
+                              const uint16_t clearBits,                       // and write or defer it            //
+                              const uint16_t setBits) {                       //                                  //
+  inaDet &ina = _Devices[device];                                             // Reference device table entry     //
+  ina.maskEnable = ((ina.maskEnable&~clearBits)|setBits)&INA_MASK_WRITABLE;   //                                  //
+  if (_ConfigBatch) bitSet(_MaskPending,device);                              // Written by commit()              //
+  else writeWord(INA_MASK_ENABLE_REGISTER,ina.maskEnable,ina.address);        // Write the new value              //
+} // of method updateMask()                                                   //                                  //
+/*******************************************************************************************************************
+** Method beginConfig starts a batch of setter calls. The setters only change the shadow registers until commit() **
+** writes each changed configuration and mask/enable register once, so reconfiguring N devices takes at most 2*N  **
+** writes and no reads. The result registers keep their values and can be read throughout.                        **
+*******************************************************************************************************************/
+void INA226_Class::beginConfig() {                                            // Collect setter changes           //
+  _ConfigBatch = true;                                                        //                                  //
+} // of method beginConfig()                                                  //                                  //
+/*******************************************************************************************************************
+** Method commit writes the registers changed since beginConfig() and ends the batch. Returns the number of       **
+** register writes made.                                                                                          **
+*******************************************************************************************************************/
+uint8_t INA226_Class::commit() {                                              // Write collected changes          //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
+  uint8_t writes = 0;                                                         //                                  //
+  for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
+    if (bitRead(_ConfigPending,i)) {                                          // Configuration changed            //
+      writeWord(INA_CONFIGURATION_REGISTER,_Devices[i].configuration,         //                                  //
+                _Devices[i].address);                                         //                                  //
+      writes++;                                                               //                                  //
+    } // of if-then configuration changed                                     //                                  //
+    if (bitRead(_MaskPending,i)) {                                            // Mask/enable changed              //
+      writeWord(INA_MASK_ENABLE_REGISTER,_Devices[i].maskEnable,              //                                  //
+                _Devices[i].address);                                         //                                  //
+      writes++;                                                               //                                  //
+    } // of if-then mask/enable changed                                       //                                  //
+  } // for-next each device loop                                              //                                  //
+  _ConfigPending = 0;                                                         //                                  //
+  _MaskPending   = 0;                                                         //                                  //
+  _ConfigBatch   = false;                                                     // Setters write directly again     //
+  return writes;                                                              //                                  //
+} // of method commit()                                                       //                                  //
+/*******************************************************************************************************************
 ** Method waitForConversion loops until the current conversion is marked as finished. If the conversion has       **
-** completed already then the flag (and interrupt pin, if activated) is also reset.                               **
+** completed already then the flag (and interrupt pin, if activated) is also reset. Otherwise it sleeps with      **
+** delay() until the conversion time computed from the configuration has passed, so long averaging settings don't **
+** flood the bus and no delayMicroseconds() call gets more than 1000us, and then polls at 1/16th of the           **
+** conversion time but at least every INA_CONVERSION_POLL_MAX microseconds. The method gives up and returns false **
+** when the conversion hasn't finished within twice the conversion time, e.g. because the device no longer        **
+** answers on the bus.                                                                                            **
 *******************************************************************************************************************/
-void INA226_Class::waitForConversion(const uint8_t deviceNumber) {            // Wait for current conversion      //
-  uint16_t conversionBits = 0;                                                //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
+bool INA226_Class::waitForConversion(const uint8_t deviceNumber) {            // Wait for current conversion      //
+  INA_TIME_API(INA_API_WAIT);                                                 //                                  //
+  bool     conversionReady = true;                                            // Set false on any timeout         //
+  uint32_t duration, startMicros, elapsed, interval;                          // Conversion timing                //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      conversionBits = 0;                                                     //                                  //
-      while(conversionBits==0) {                                              //                                  //
-        conversionBits = readWord(INA_MASK_ENABLE_REGISTER,ina.address)       //                                  //
-                         &(uint16_t)8;                                        //                                  //
+      duration    = conversionMicros(_Devices[i].configuration);              // Duration from the configuration  //
+      startMicros = micros();                                                 // Start of the wait                //
+      interval    = duration>>4;                                              // Poll interval after the          //
+      if (interval>INA_CONVERSION_POLL_MAX) interval = INA_CONVERSION_POLL_MAX;// expected end                    //
+      while(!(readMask(_Devices[i])&                                          // Loop until the conversion ready  //
+              INA_CONVERSION_READY_MASK) || _TransmissionStatus!=0) {         // flag has been read               //
+        elapsed = micros()-startMicros;                                       //                                  //
+        if (elapsed>2*duration+INA_CONVERSION_SLACK) {                        // Stop waiting after the timeout   //
+          conversionReady = false;                                            //                                  //
+          break;                                                              //                                  //
+        } // of if-then timeout                                               //                                  //
+        if (elapsed<duration) {                                               // Sleep until the expected end,    //
+          delay((duration-elapsed)/1000);                                     // whole milliseconds first         //
+          delayMicroseconds((duration-elapsed)%1000);                         //                                  //
+        } else delayMicroseconds(interval);                                   // Don't flood the I2C bus          //
       } // of while the conversion hasn't finished                            //                                  //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
+  return conversionReady;                                                     // false if any device timed out    //
 } // of method waitForConversion()                                            //                                  //
 /*******************************************************************************************************************
+** Method startConversion begins a non-blocking wait for the next conversion. In triggered mode the configuration **
+** register is written from its shadow to trigger a new conversion, in continuous mode the conversion ready flag  **
+** is cleared so that it only reports a conversion which completes after this call. The expected duration is      **
+** computed from the averaging and conversion time settings so that pollConversion() need not access the bus      **
+** before then.                                                                                                   **
+*******************************************************************************************************************/
+void INA226_Class::startConversion(const uint8_t deviceNumber) {              // Start waiting for a conversion   //
+  const inaDet  &ina        = _Devices[deviceNumber%_DeviceCount];            // Reference device table entry     //
+  inaConversion &conversion = _Conversions[deviceNumber%_DeviceCount];        // Reference conversion state       //
+  if (!bitRead(ina.operatingMode,2))                                          // Triggered mode, write back to    //
+    writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address);      // trigger the next conversion      //
+  else readMask(ina);                                                         // Continuous mode, clear the flag  //
+  conversion.started  = micros();                                             // Remember when we started         //
+  conversion.duration = conversionMicros(ina.configuration);                  // and how long it should take      //
+  conversion.pending  = true;                                                 //                                  //
+} // of method startConversion()                                              //                                  //
+/*******************************************************************************************************************
+** Method pollConversion returns the state of the conversion started with startConversion() without blocking.     **
+** Until the expected duration has passed INA_CONVERSION_PENDING is returned without any bus access, after that   **
+** the conversion ready flag is read on each call. Once it is set INA_CONVERSION_READY is returned and the        **
+** callback, if one has been set, is called. If the flag hasn't been set within twice the expected duration then  **
+** INA_CONVERSION_TIMEOUT is returned. Both end the wait, further calls return INA_CONVERSION_IDLE.               **
+*******************************************************************************************************************/
+uint8_t INA226_Class::pollConversion(const uint8_t deviceNumber) {            // Check state without blocking     //
+  INA_TIME_API(INA_API_POLL);                                                 //                                  //
+  uint8_t        device     = deviceNumber%_DeviceCount;                      // Index into the device table      //
+  inaConversion &conversion = _Conversions[device];                           // Reference conversion state       //
+  if (!conversion.pending) return INA_CONVERSION_IDLE;                        // Nothing is being waited for      //
+  uint32_t elapsed = micros()-conversion.started;                             // Time since start                 //
+  if (elapsed<conversion.duration) return INA_CONVERSION_PENDING;             // Too early to look                //
+  if ((readMask(_Devices[device])&                                            // Check the conversion ready flag  //
+       INA_CONVERSION_READY_MASK) && _TransmissionStatus==0) {                // of the device                    //
+    conversion.pending = false;                                               //                                  //
+    if (_ConversionCallback!=NULL) _ConversionCallback(device);               // Tell the application             //
+    return INA_CONVERSION_READY;                                              //                                  //
+  } // of if-then conversion ready                                            //                                  //
+  if (elapsed>2*conversion.duration+INA_CONVERSION_SLACK) {                   // Give up waiting                  //
+    conversion.pending = false;                                               //                                  //
+    return INA_CONVERSION_TIMEOUT;                                            //                                  //
+  } // of if-then timeout                                                     //                                  //
+  return INA_CONVERSION_PENDING;                                              //                                  //
+} // of method pollConversion()                                               //                                  //
+/*******************************************************************************************************************
+** Method getConversionMicros returns the expected duration of one conversion of the device in microseconds       **
+*******************************************************************************************************************/
+uint32_t INA226_Class::getConversionMicros(const uint8_t deviceNumber) {      // Expected conversion duration     //
+  return conversionMicros(_Devices[deviceNumber%_DeviceCount].configuration); // From the shadow register         //
+} // of method getConversionMicros()                                          //                                  //
+/*******************************************************************************************************************
+** Method setConversionCallback sets the function pollConversion() calls when a conversion is ready, or NULL      **
+*******************************************************************************************************************/
+void INA226_Class::setConversionCallback(inaCallback callback) {              // Set function called when ready   //
+  _ConversionCallback = callback;                                             //                                  //
+} // of method setConversionCallback()                                        //                                  //
+/*******************************************************************************************************************
+** Method conversionMicros computes the duration of a complete conversion from the configuration register. This   **
+** is the number of averages times the sum of the bus and shunt conversion times, counting only the measurements  **
+** which are enabled by the operating mode.                                                                       **
+*******************************************************************************************************************/
+uint32_t INA226_Class::conversionMicros(const uint16_t configRegister) {      // Duration from configuration      //
+  uint32_t duration = 0;                                                      //                                  //
+  if (bitRead(configRegister,0))                                              // Shunt measurement enabled        //
+    duration += conversionTimes[(configRegister&INA_CONFIG_SHUNT_TIME_MASK)>>3];//                                //
+  if (bitRead(configRegister,1))                                              // Bus measurement enabled          //
+    duration += conversionTimes[(configRegister&INA_CONFIG_BUS_TIME_MASK)>>6];//                                  //
+  return duration*averagingCounts[(configRegister&INA_CONFIG_AVG_MASK)>>9];   //                                  //
+} // of method conversionMicros()                                             //                                  //
+/*******************************************************************************************************************
 ** Method setAlertPinOnConversion configure the INA226 to pull the ALERT pin low when a conversion is complete    **
 *******************************************************************************************************************/
 void INA226_Class::setAlertPinOnConversion(const bool alertState,             // Enable pin change on conversion  //
                                            const uint8_t deviceNumber ) {     //                                  //
-  inaDet ina;                                                                 // Hold device details in structure //
-  EEPROM.get((deviceNumber%_DeviceCount)*sizeof(ina),ina);                    // Read EEPROM values               //
-  uint16_t alertRegister;                                                     // Hold the alert register          //
+  INA_TIME_API(INA_API_CONFIG);                                               //                                  //
   for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
     if(deviceNumber==UINT8_MAX || deviceNumber%_DeviceCount==i ) {            // If this device needs setting     //
-      alertRegister = readWord(INA_MASK_ENABLE_REGISTER,ina.address);         // Get the current register         //
-      if (!alertState) alertRegister &= ~((uint16_t)1<<10);                   // zero out the alert bit           //
-                  else alertRegister |= (uint16_t)(1<<10);                    // turn on the alert bit            //
-      writeWord(INA_MASK_ENABLE_REGISTER,alertRegister,ina.address);          // Write register back to device    //
+      updateMask(i,INA_ALERT_CONVERSION_READY,                                // Turn the alert bit on or off     //
+                 alertState ? INA_ALERT_CONVERSION_READY : 0);                //                                  //
     } // of if this device needs to be set                                    //                                  //
   } // for-next each device loop                                              //                                  //
-} // of method setAlertPinOnConversion                                        //----------------------------------//
+} // of method setAlertPinOnConversion                                        //                                  //
+/*******************************************************************************************************************
+** Method saveDevices writes the topology record to EEPROM, allowing restoreDevices() and fastBegin() to skip the **
+** bus scan on the next start. The record holds the INA_TOPOLOGY_VERSION, the number of devices, the device table **
+** including the shadow configuration and mask/enable registers of each device and a CRC-8 of all the preceding   **
+** bytes. Returns the number of devices saved or 0 if the record doesn't fit into the EEPROM.                     **
+*******************************************************************************************************************/
+uint8_t INA226_Class::saveDevices(const uint16_t eepromAddress) {             // Write topology record to EEPROM  //
+  uint16_t checksumAddress = eepromAddress+2+_DeviceCount*sizeof(inaDet);     // Version and count come first     //
+  if (checksumAddress>=EEPROM.length()) return 0;                             // Record won't fit into the EEPROM //
+  EEPROM.update(eepromAddress,INA_TOPOLOGY_VERSION);                          // Write the header                 //
+  EEPROM.update(eepromAddress+1,_DeviceCount);                                //                                  //
+  for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device found       //
+    EEPROM.put(eepromAddress+2+i*sizeof(inaDet),_Devices[i]);                 // put() only updates bytes which   //
+  } // for-next each device loop                                              // differ                           //
+  EEPROM.update(checksumAddress,topologyChecksum(eepromAddress,_DeviceCount));// Seal the record                  //
+  return _DeviceCount;                                                        // Return number of devices saved   //
+} // of method saveDevices()                                                  //                                  //
+/*******************************************************************************************************************
+** Method restoreDevices loads the topology record written by saveDevices() and confirms each recorded device     **
+** with a single manufacturer ID read. The calibration and configuration registers are then read back and are     **
+** only written if they differ from the record and a non-zero mask/enable register is written back, so devices    **
+** which kept their settings aren't disturbed. Returns the number of devices restored, or 0 if the record is      **
+** missing, from another version, corrupted or if a device didn't answer, in which case the device table is empty **
+** and begin() will scan the bus again. When "calibrated" isn't NULL its calibration and LSBs replace the         **
+** recorded ones before the registers are compared, so that only the new calibration is ever written.             **
+*******************************************************************************************************************/
+uint8_t INA226_Class::restoreDevices(const uint16_t eepromAddress) {          // Load and verify topology record  //
+  return restoreDevices(eepromAddress,NULL);                                  // Keep the recorded calibration    //
+} // of method restoreDevices()                                               //                                  //
+uint8_t INA226_Class::restoreDevices(const uint16_t eepromAddress,            // Load and verify topology record, //
+                                     const inaDet *calibrated) {              // optionally with new calibration  //
+  uint8_t deviceCount = EEPROM.read(eepromAddress+1);                         // Number of devices stored         //
+  if (EEPROM.read(eepromAddress)!=INA_TOPOLOGY_VERSION ||                     // Erased EEPROM reads as 0xFF and  //
+      deviceCount==0 || deviceCount>INA_MAX_DEVICES ||                        // old records have no version      //
+      EEPROM.read(eepromAddress+2+deviceCount*sizeof(inaDet))!=               //                                  //
+      topologyChecksum(eepromAddress,deviceCount)) return 0;                  //                                  //
+  _Transport->begin();                                                        // Start the I2C bus if needed      //
+  _DeviceCount = 0;                                                           // Table is invalid while loading   //
+  for(uint8_t i=0;i<deviceCount;i++) {                                        // Load and confirm each device     //
+    EEPROM.get(eepromAddress+2+i*sizeof(inaDet),_Devices[i]);                 //                                  //
+    if ((uint16_t)readWord(INA_MANUFACTURER_ID_REGISTER,_Devices[i].address,  // One transaction per device       //
+                           true)!=INA_MANUFACTURER_ID ||                      //                                  //
+        _TransmissionStatus!=0) return 0;                                     // Device missing or replaced       //
+    if (calibrated!=NULL) {                                                   // Requested calibration replaces   //
+      _Devices[i].calibration = calibrated->calibration;                      // the recorded one                 //
+      _Devices[i].current_LSB = calibrated->current_LSB;                      //                                  //
+      _Devices[i].power_LSB   = calibrated->power_LSB;                        //                                  //
+    } // of if-then new calibration                                           //                                  //
+  } // for-next each device loop                                              //                                  //
+  for(uint8_t i=0;i<deviceCount;i++) {                                        // Restore the settings if needed   //
+    const inaDet &ina = _Devices[i];                                          // Reference device table entry     //
+    if ((uint16_t)readWord(INA_CALIBRATION_REGISTER,ina.address,true)!=       //                                  //
+        ina.calibration)                                                      //                                  //
+      writeWord(INA_CALIBRATION_REGISTER,ina.calibration,ina.address);        // Write the calibration value      //
+    if ((uint16_t)readWord(INA_CONFIGURATION_REGISTER,ina.address,true)!=     //                                  //
+        ina.configuration)                                                    //                                  //
+      writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address);    // Write the configuration          //
+    if (ina.maskEnable&INA_ALERT_FUNCTION_MASK)                               // Restore an armed limit           //
+      writeWord(INA_ALERT_LIMIT_REGISTER,ina.alertLimit,ina.address);         //                                  //
+    if (ina.maskEnable!=0)                                                    // Reading the mask would clear     //
+      writeWord(INA_MASK_ENABLE_REGISTER,ina.maskEnable,ina.address);         // its flags, so just write it      //
+  } // for-next each device loop                                              //                                  //
+  _DeviceCount = deviceCount;                                                 // All devices confirmed            //
+  return _DeviceCount;                                                        // Return number of devices found   //
+} // of method restoreDevices()                                               //                                  //
+/*******************************************************************************************************************
+** Method crc8 adds one byte to a CRC-8 with the polynomial 0x07                                                  **
+*******************************************************************************************************************/
+uint8_t INA226_Class::crc8(uint8_t crc, const uint8_t data) {                 // Add a byte to a CRC-8            //
+  crc ^= data;                                                                //                                  //
+  for(uint8_t j=0;j<8;j++) crc = crc&0x80 ? (crc<<1)^0x07 : crc<<1;           // Shift out the 8 bits             //
+  return crc;                                                                 //                                  //
+} // of method crc8()                                                         //                                  //
+/*******************************************************************************************************************
+** Method topologyChecksum computes the CRC-8 (polynomial 0x07) of the topology record at "eepromAddress"         **
+** for "deviceCount" devices, excluding the checksum byte itself                                                  **
+*******************************************************************************************************************/
+uint8_t INA226_Class::topologyChecksum(const uint16_t eepromAddress,          // CRC-8 of the EEPROM record       //
+                                       const uint8_t deviceCount) {           //                                  //
+  uint8_t crc = 0;                                                            //                                  //
+  for(uint16_t i=0;i<2+deviceCount*sizeof(inaDet);i++)                        // Each byte of the record          //
+    crc = crc8(crc,EEPROM.read(eepromAddress+i));                             //                                  //
+  return crc;                                                                 //                                  //
+} // of method topologyChecksum()                                             //                                  //
+/*******************************************************************************************************************
+** INA226_Sampler class constructor. The sample buffer is indexed with free-running 8-bit head and tail counters, **
+** which are read and written atomically on every platform, so the size has to be a power of 2 of at most 128.    **
+*******************************************************************************************************************/
+INA226_Sampler::INA226_Sampler(INA226_Class &ina) : _INA(ina) {               // Class constructor                //
+  static_assert(INA_SAMPLE_BUFFER_SIZE<=128 &&                                // Check the buffer size at         //
+                (INA_SAMPLE_BUFFER_SIZE&(INA_SAMPLE_BUFFER_SIZE-1))==0,       // compile time                     //
+                "INA_SAMPLE_BUFFER_SIZE must be a power of 2 up to 128");     //                                  //
+} // of class constructor                                                     //                                  //
+/*******************************************************************************************************************
+** Method begin sets which of the result registers sampleISR() reads and enables the ALERT pin on conversion      **
+** ready for the device or all devices. Only reading what is needed keeps the time spent in the interrupt handler **
+** short enough to keep up with the fastest conversion settings. The buffer is emptied.                           **
+*******************************************************************************************************************/
+void INA226_Sampler::begin(const uint8_t sampleFields,                        // Set registers to be sampled      //
+                           const uint8_t deviceNumber) {                      //                                  //
+  _SampleFields = sampleFields;                                               //                                  //
+  _Tail         = _Head;                                                      // Discard any old samples          //
+  _INA.setAlertPinOnConversion(true,deviceNumber);                            // Pull ALERT low when ready        //
+} // of method begin()                                                        //                                  //
+/*******************************************************************************************************************
+** Method sampleISR is called from the ALERT pin interrupt handler with interrupts enabled again, as the Wire     **
+** library needs them. The mask/enable register is read first, which releases the ALERT pin so that the next      **
+** conversion causes a new interrupt. If a conversion was ready the selected registers are read using repeated    **
+** starts and stored in the buffer without conversion. If the buffer is full the sample is dropped and counted.   **
+*******************************************************************************************************************/
+void INA226_Sampler::sampleISR(const uint8_t deviceNumber) {                  // Capture sample, called from ISR  //
+  uint8_t       device = deviceNumber%_INA._DeviceCount;                      // Index into the device table      //
+  const inaDet &ina    = _INA._Devices[device];                               // Reference device table entry     //
+  if (!(_INA.readMask(ina,true)&                                              // Reading the register clears the  //
+        INA_CONVERSION_READY_MASK)) return;                                   // ALERT pin, ignore other alerts   //
+  uint8_t head = _Head;                                                       // Only this method changes _Head   //
+  if ((uint8_t)(head-_Tail)>=INA_SAMPLE_BUFFER_SIZE) {                        // Buffer is full                   //
+    _Overflows = _Overflows+1;                                                //                                  //
+    return;                                                                   //                                  //
+  } // of if-then buffer full                                                 //                                  //
+  volatile inaRawSample &sample = _Buffer[head&(INA_SAMPLE_BUFFER_SIZE-1)];   // Next free entry                  //
+  sample.timestamp = micros();                                                //                                  //
+  sample.device    = device;                                                  //                                  //
+  sample.bus       = readField(INA_SAMPLE_BUS,                                // Read the selected registers      //
+                               INA_BUS_VOLTAGE_REGISTER,ina.address);         //                                  //
+  sample.shunt     = readField(INA_SAMPLE_SHUNT,                              //                                  //
+                               INA_SHUNT_VOLTAGE_REGISTER,ina.address);       //                                  //
+  sample.current   = readField(INA_SAMPLE_CURRENT,                            //                                  //
+                               INA_CURRENT_REGISTER,ina.address);             //                                  //
+  sample.power     = readField(INA_SAMPLE_POWER,                              //                                  //
+                               INA_POWER_REGISTER,ina.address);               //                                  //
+  _Head = head+1;                                                             // Publish sample to the consumer   //
+} // of method sampleISR()                                                    //                                  //
+/*******************************************************************************************************************
+** Method readField reads a result register using a repeated start if it has been selected in begin(), else 0     **
+*******************************************************************************************************************/
+int16_t INA226_Sampler::readField(const uint8_t field, const uint8_t addr,    // Read register if it is selected  //
+                                  const uint8_t deviceAddr) {                 //                                  //
+  if (!(_SampleFields&field)) return 0;                                       // Register not sampled             //
+  return _INA.readWord(addr,deviceAddr,true);                                 //                                  //
+} // of method readField()                                                    //                                  //
+/*******************************************************************************************************************
+** Method available returns the number of samples waiting in the buffer                                           **
+*******************************************************************************************************************/
+uint8_t INA226_Sampler::available() {                                         // Number of samples in buffer      //
+  return (uint8_t)(_Head-_Tail);                                              //                                  //
+} // of method available()                                                    //                                  //
+/*******************************************************************************************************************
+** Method read takes up to "maxSamples" samples out of the buffer, converts them to engineering units using the   **
+** device's LSBs and returns the number of samples copied. It is called from loop() and, as it only ever changes  **
+** _Tail while sampleISR() only ever changes _Head, it doesn't need to disable interrupts.                        **
+*******************************************************************************************************************/
+uint8_t INA226_Sampler::read(inaSample *samples, const uint8_t maxSamples) {  // Take and convert samples         //
+  uint8_t tail  = _Tail;                                                      // Only this method changes _Tail   //
+  uint8_t count = _Head-tail;                                                 // Samples published so far         //
+  if (count>maxSamples) count = maxSamples;                                   //                                  //
+  for(uint8_t i=0;i<count;i++) {                                              // Convert each sample              //
+    volatile inaRawSample &sample = _Buffer[(tail+i)&(INA_SAMPLE_BUFFER_SIZE-1)];//                               //
+    const inaDet &ina = _INA._Devices[sample.device];                         // LSBs of the sampled device       //
+    samples[i].timestamp       = sample.timestamp;                            //                                  //
+    samples[i].device          = sample.device;                               //                                  //
+    samples[i].busMilliVolts   = _INA.busToMilliVolts(sample.bus);            //                                  //
+    samples[i].shuntMicroVolts = _INA.shuntToMicroVolts(sample.shunt);        //                                  //
+    samples[i].busMicroAmps    = _INA.currentToMicroAmps(sample.current,ina); //                                  //
+    samples[i].busMicroWatts   = _INA.powerToMicroWatts(sample.power,ina);    //                                  //
+  } // of for-next each sample                                                //                                  //
+  _Tail = tail+count;                                                         // Free the entries for sampleISR() //
+  return count;                                                               //                                  //
+} // of method read()                                                         //                                  //
+/*******************************************************************************************************************
+** Method getOverflows returns the number of samples dropped because the buffer was full. The 32-bit counter may  **
+** be updated by sampleISR() while it is being read, so it is read until two consecutive values are the same.     **
+*******************************************************************************************************************/
+uint32_t INA226_Sampler::getOverflows() {                                     // Samples lost as buffer was full  //
+  uint32_t overflows;                                                         //                                  //
+  do overflows = _Overflows; while (overflows!=_Overflows);                   // Read until the value is stable   //
+  return overflows;                                                           //                                  //
+} // of method getOverflows()                                                 //                                  //
+/*******************************************************************************************************************
+** Function mulDiv returns value*multiplier/divisor without the 64-bit overflow of computing the product first,   **
+** as long as divisor*multiplier fits into 63 bits                                                                **
+*******************************************************************************************************************/
+static int64_t mulDiv(const int64_t value, const uint32_t multiplier,         // value*multiplier/divisor         //
+                      const uint32_t divisor) {                               //                                  //
+  return value/divisor*multiplier+value%divisor*multiplier/divisor;           //                                  //
+} // of function mulDiv()                                                     //                                  //
+/*******************************************************************************************************************
+** INA226_Accumulator class constructor                                                                           **
+*******************************************************************************************************************/
+INA226_Accumulator::INA226_Accumulator(INA226_Class &ina,                     // Class constructor                //
+                                       const uint8_t deviceNumber) :          //                                  //
+  _INA(ina), _DeviceNumber(deviceNumber) {}                                   //                                  //
+/*******************************************************************************************************************
+** Method accumulate reads the mask/enable register, which also releases the ALERT pin, and if a conversion is    **
+** ready adds its current and power registers, read using repeated starts. Returns true if a conversion was       **
+** added. Every conversion has to be read for the totals to be complete, so this is called from the ALERT pin     **
+** interrupt handler with the conversion ready alert enabled, or from loop() when pollConversion() reports a      **
+** conversion.                                                                                                    **
+*******************************************************************************************************************/
+bool INA226_Accumulator::accumulate() {                                       // Add conversion if it is ready    //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  if (!(_INA.readMask(ina,true)&                                              // Read and clear the flag          //
+        INA_CONVERSION_READY_MASK) || _INA._TransmissionStatus!=0)            //                                  //
+    return false;                                                             // No new conversion                //
+  int16_t  currentRaw = _INA.readWord(INA_CURRENT_REGISTER,ina.address,true); // Read the results                 //
+  uint16_t powerRaw   = _INA.readWord(INA_POWER_REGISTER,ina.address,true);   //                                  //
+  add(currentRaw,powerRaw);                                                   //                                  //
+  return true;                                                                //                                  //
+} // of method accumulate()                                                   //                                  //
+/*******************************************************************************************************************
+** Method add adds the current and power registers of one conversion, e.g. as read by the application. The power  **
+** register holds the magnitude only, so it gets the sign of the current and energy flowing back, as when a       **
+** battery is being charged, is subtracted. If the device's settings have changed then the sums are folded into   **
+** the totals with the previous conversion period first. The sums are also folded before they can overflow, which **
+** happens after 32767 conversions at the latest, the only time a 64-bit multiplication is done here.             **
+*******************************************************************************************************************/
+void INA226_Accumulator::add(const int16_t currentRaw,                        // Add one conversion               //
+                             const uint16_t powerRaw) {                       //                                  //
+  if (_Conversions==INT16_MAX || _Configuration!=                             // Fold before overflowing or if    //
+      _INA._Devices[_DeviceNumber%_INA._DeviceCount].configuration) fold();   // the settings have changed        //
+  _CurrentSum += currentRaw;                                                  //                                  //
+  _PowerSum   += currentRaw<0 ? -(int32_t)powerRaw : (int32_t)powerRaw;       // Power has the current's sign     //
+  _Conversions++;                                                             //                                  //
+} // of method add()                                                          //                                  //
+/*******************************************************************************************************************
+** Method fold multiplies the sums by the conversion period of the settings they were taken with, adds them to    **
+** the totals and clears them. With full scale readings at the fastest settings the charge total lasts about 8    **
+** years and the energy total about 4 years before overflowing.                                                   **
+*******************************************************************************************************************/
+void INA226_Accumulator::fold() {                                             // Move sums into the totals        //
+  uint32_t period = _INA.conversionMicros(_Configuration);                    // Conversion period in us          //
+  _ChargeRaw        += (int64_t)_CurrentSum*period;                           //                                  //
+  _EnergyRaw        += (int64_t)_PowerSum*period;                             //                                  //
+  _Micros           += (uint64_t)_Conversions*period;                         //                                  //
+  _TotalConversions += _Conversions;                                          //                                  //
+  _CurrentSum        = 0;                                                     //                                  //
+  _PowerSum          = 0;                                                     //                                  //
+  _Conversions       = 0;                                                     //                                  //
+  _Configuration     = _INA._Devices[_DeviceNumber%_INA._DeviceCount].        // Settings of the next sums        //
+                       configuration;                                         //                                  //
+} // of method fold()                                                         //                                  //
+/*******************************************************************************************************************
+** Method read returns the charge in uAh, the energy in uWh, the integrated time and the number of conversions    **
+** since the last reset. Interrupts are disabled only while the totals are copied, and cleared if "resetTotals"   **
+** is set, so no conversion is lost between two readings. The conversion to engineering units uses the device's   **
+** current and power LSBs (in nA and nW) and is done afterwards.                                                  **
+*******************************************************************************************************************/
+void INA226_Accumulator::read(inaEnergy &energy, const bool resetTotals) {    // Read and optionally reset        //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  int64_t  chargeRaw, energyRaw;                                              // Totals copied from add()         //
+  uint64_t elapsed;                                                           //                                  //
+  uint32_t conversions;                                                       //                                  //
+  {                                                                           //                                  //
+    inaInterruptLock lock;                                                    // Stop add() while copying         //
+    fold();                                                                   //                                  //
+    chargeRaw   = _ChargeRaw;                                                 //                                  //
+    energyRaw   = _EnergyRaw;                                                 //                                  //
+    elapsed     = _Micros;                                                    //                                  //
+    conversions = _TotalConversions;                                          //                                  //
+    if (resetTotals) {                                                        //                                  //
+      _ChargeRaw        = 0;                                                  //                                  //
+      _EnergyRaw        = 0;                                                  //                                  //
+      _Micros           = 0;                                                  //                                  //
+      _TotalConversions = 0;                                                  //                                  //
+    } // of if-then reset                                                     //                                  //
+  } // of interrupt lock                                                      //                                  //
+  energy.microAmpHours  = mulDiv(chargeRaw,ina.current_LSB,3600000000UL)/1000;// LSB*us to nAh, then uAh          //
+  energy.microWattHours = mulDiv(energyRaw,ina.power_LSB,3600000000UL)/1000;  // LSB*us to nWh, then uWh          //
+  energy.seconds        = elapsed/1000000;                                    //                                  //
+  energy.conversions    = conversions;                                        //                                  //
+} // of method read()                                                         //                                  //
+/*******************************************************************************************************************
+** Method reset clears the totals and any conversions not yet folded into them                                    **
+*******************************************************************************************************************/
+void INA226_Accumulator::reset() {                                            // Clear the totals                 //
+  inaInterruptLock lock;                                                      // Stop add() while clearing        //
+  fold();                                                                     // Clears the sums                  //
+  _ChargeRaw        = 0;                                                      //                                  //
+  _EnergyRaw        = 0;                                                      //                                  //
+  _Micros           = 0;                                                      //                                  //
+  _TotalConversions = 0;                                                      //                                  //
+} // of method reset()                                                        //                                  //
+/*******************************************************************************************************************
+** INA226_Scheduler class constructor                                                                             **
+*******************************************************************************************************************/
+INA226_Scheduler::INA226_Scheduler(INA226_Class &ina) : _INA(ina) {           // Class constructor                //
+  memset(_Schedules,0,sizeof(_Schedules));                                    // No device scheduled yet          //
+} // of class constructor                                                     //                                  //
+/*******************************************************************************************************************
+** Method begin is called after INA226_Class::begin() and the setters. It clears the conversion ready flag of     **
+** every device and sets its first deadline one conversion period from now, when the conversion in progress will  **
+** have finished at the latest. The statistics are cleared.                                                       **
+*******************************************************************************************************************/
+void INA226_Scheduler::begin() {                                              // Start scheduling all devices     //
+  resetStats();                                                               //                                  //
+  for(uint8_t i=0;i<_INA._DeviceCount;i++) {                                  // Loop for each device found       //
+    const inaDet &ina = _INA._Devices[i];                                     // Reference device table entry     //
+    _INA.readMask(ina,true);                                                  // Clear the ready flag             //
+    _Schedules[i].deadline = micros()+_INA.conversionMicros(ina.configuration);// Due after one conversion        //
+  } // for-next each device loop                                              //                                  //
+} // of method begin()                                                        //                                  //
+/*******************************************************************************************************************
+** Method tick reads every device whose deadline has passed and returns the number of samples stored, at most     **
+** "maxSamples". A device which is due but whose conversion isn't ready yet costs one register read and is looked **
+** at again after 1/16th of its conversion period. After a sample the deadline moves on by one period, or if the  **
+** tick came more than a period late, by as many periods as were missed, which are counted. Devices in triggered  **
+** mode are triggered again after being read. When "samples" is full the remaining devices are serviced first in  **
+** the next tick, so every device gets its turn.                                                                  **
+*******************************************************************************************************************/
+uint8_t INA226_Scheduler::tick(inaSample *samples, const uint8_t maxSamples) {// Read all devices which are due   //
+  uint8_t count = 0;                                                          // Samples stored                   //
+  for(uint8_t n=0;n<_INA._DeviceCount;n++) {                                  // Round-robin over all devices     //
+    uint8_t       device   = (_Next+n)%_INA._DeviceCount;                     //                                  //
+    const inaDet &ina      = _INA._Devices[device];                           // Reference device table entry     //
+    inaSchedule  &schedule = _Schedules[device];                              //                                  //
+    uint32_t      now      = micros();                                        //                                  //
+    if ((int32_t)(now-schedule.deadline)<0) continue;                         // Not due yet                      //
+    if (count>=maxSamples) {                                                  // No space left, start with        //
+      _Next = device;                                                         // this device next time            //
+      return count;                                                           //                                  //
+    } // of if-then samples full                                              //                                  //
+    uint32_t     period = _INA.conversionMicros(ina.configuration);           // Scheduled period                 //
+    inaRawSample raw;                                                         // Raw register values              //
+    if (!_INA.readResults(ina,raw,true)) {                                    // Conversion not finished yet      //
+      schedule.deadline = now+(period>>4)+1;                                  // Look again soon                  //
+      continue;                                                               //                                  //
+    } // of if-then not ready                                                 //                                  //
+    if (!bitRead(ina.operatingMode,2))                                        // Triggered mode, start the next   //
+      _INA.writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address);// conversion                      //
+    uint32_t slip = now-schedule.deadline;                                    // Lateness of this tick            //
+    if (period>0 && slip>=period) {                                           // Conversions were overwritten     //
+      schedule.missed  += slip/period;                                        //                                  //
+      schedule.deadline = now+period;                                         // Resynchronize                    //
+    } else schedule.deadline += period;                                       // Stay on the conversion grid      //
+    if (schedule.samples==0) schedule.firstSample = raw.timestamp;            // Statistics                       //
+    schedule.lastSample = raw.timestamp;                                      //                                  //
+    schedule.samples++;                                                       //                                  //
+    schedule.totalSlip += slip;                                               //                                  //
+    if (slip>schedule.maxSlip) schedule.maxSlip = slip;                       //                                  //
+    inaSample &sample      = samples[count++];                                // Convert into the next sample     //
+    sample.timestamp       = raw.timestamp;                                   //                                  //
+    sample.device          = device;                                          //                                  //
+    sample.busMilliVolts   = _INA.busToMilliVolts(raw.bus);                   //                                  //
+    sample.shuntMicroVolts = _INA.shuntToMicroVolts(raw.shunt);               //                                  //
+    sample.busMicroAmps    = _INA.currentToMicroAmps(raw.current,ina);        //                                  //
+    sample.busMicroWatts   = _INA.powerToMicroWatts(raw.power,ina);           //                                  //
+  } // for-next each device                                                   //                                  //
+  _Next = _INA._DeviceCount>0 ? (_Next+1)%_INA._DeviceCount : 0;              // Rotate the starting device       //
+  return count;                                                               //                                  //
+} // of method tick()                                                         //                                  //
+/*******************************************************************************************************************
+** Method getMicrosToNext returns the time until the earliest deadline, 0 if a device is already due, so that the **
+** caller can sleep or do other work until then                                                                   **
+*******************************************************************************************************************/
+uint32_t INA226_Scheduler::getMicrosToNext() {                                // Time until next device is due    //
+  uint32_t now     = micros();                                                //                                  //
+  uint32_t minimum = UINT32_MAX;                                              //                                  //
+  for(uint8_t i=0;i<_INA._DeviceCount;i++) {                                  // Loop for each device found       //
+    int32_t remaining = (int32_t)(_Schedules[i].deadline-now);                //                                  //
+    if (remaining<=0) return 0;                                               // Already due                      //
+    if ((uint32_t)remaining<minimum) minimum = remaining;                     //                                  //
+  } // for-next each device loop                                              //                                  //
+  return minimum;                                                             //                                  //
+} // of method getMicrosToNext()                                              //                                  //
+/*******************************************************************************************************************
+** Method getStats returns the number of samples, the achieved sample rate in mHz, the scheduled period, the mean **
+** and worst lateness of the ticks reading the device and the number of conversions which were never read         **
+*******************************************************************************************************************/
+void INA226_Scheduler::getStats(const uint8_t deviceNumber,                   // Rate and slip of a device        //
+                                inaScheduleStats &stats) {                    //                                  //
+  uint8_t            device   = deviceNumber%_INA._DeviceCount;               // Index into the device table      //
+  const inaSchedule &schedule = _Schedules[device];                           //                                  //
+  uint32_t           elapsed  = schedule.lastSample-schedule.firstSample;     // Time between first and last      //
+  stats.samples          = schedule.samples;                                  //                                  //
+  stats.milliHertz       = elapsed==0 ? 0 :                                   // Intervals per second             //
+                           (uint64_t)(schedule.samples-1)*1000000000/elapsed; //                                  //
+  stats.conversionMicros = _INA.conversionMicros(                             //                                  //
+                             _INA._Devices[device].configuration);            //                                  //
+  stats.averageSlip      = schedule.samples==0 ? 0 :                          //                                  //
+                           schedule.totalSlip/schedule.samples;               //                                  //
+  stats.maxSlip          = schedule.maxSlip;                                  //                                  //
+  stats.missed           = schedule.missed;                                   //                                  //
+} // of method getStats()                                                     //                                  //
+/*******************************************************************************************************************
+** Method resetStats clears the statistics of all devices, the deadlines are kept                                 **
+*******************************************************************************************************************/
+void INA226_Scheduler::resetStats() {                                         // Clear the statistics             //
+  for(uint8_t i=0;i<INA_MAX_DEVICES;i++) {                                    // Loop for each table entry        //
+    uint32_t deadline = _Schedules[i].deadline;                               // Keep the deadline                //
+    memset(&_Schedules[i],0,sizeof(inaSchedule));                             //                                  //
+    _Schedules[i].deadline = deadline;                                        //                                  //
+  } // for-next each table entry                                              //                                  //
+} // of method resetStats()                                                   //                                  //
+/*******************************************************************************************************************
+** Function squareRoot returns the integer square root of a 64-bit value, computed bit by bit                     **
+*******************************************************************************************************************/
+static uint32_t squareRoot(uint64_t value) {                                  // Integer square root              //
+  uint64_t root = 0;                                                          //                                  //
+  uint64_t bit  = (uint64_t)1<<62;                                            // Highest power of 4               //
+  while (bit>value) bit >>= 2;                                                //                                  //
+  while (bit!=0) {                                                            //                                  //
+    if (value>=root+bit) {                                                    //                                  //
+      value -= root+bit;                                                      //                                  //
+      root   = (root>>1)+bit;                                                 //                                  //
+    } else root >>= 1;                                                        //                                  //
+    bit >>= 2;                                                                //                                  //
+  } // of while bits left                                                     //                                  //
+  return root;                                                                //                                  //
+} // of function squareRoot()                                                 //                                  //
+/*******************************************************************************************************************
+** INA226_Statistics class constructor                                                                            **
+*******************************************************************************************************************/
+INA226_Statistics::INA226_Statistics(INA226_Class &ina,                       // Class constructor                //
+                                     const uint8_t deviceNumber) :            //                                  //
+  _INA(ina), _DeviceNumber(deviceNumber) {                                    //                                  //
+  memset(_DecimationSum,0,sizeof(_DecimationSum));                            //                                  //
+  memset(_Running,0,sizeof(_Running));                                        //                                  //
+  memset(_Completed,0,sizeof(_Completed));                                    //                                  //
+} // of class constructor                                                     //                                  //
+/*******************************************************************************************************************
+** Method setWindow sets the number of samples in a window, whether windows are tumbling or sliding and the       **
+** number of conversions averaged into each sample, then starts an empty window. Sliding windows keep their       **
+** samples in a buffer and are limited to INA_STATISTICS_WINDOW_SIZE samples, tumbling windows can have up to     **
+** 65535 samples.                                                                                                 **
+*******************************************************************************************************************/
+void INA226_Statistics::setWindow(const uint16_t windowSamples,               // Set window length and type       //
+                                  const uint8_t  windowType,                  //                                  //
+                                  const uint8_t  decimation) {                //                                  //
+  _WindowType    = windowType;                                                //                                  //
+  _WindowSamples = windowSamples==0 ? 1 : windowSamples;                      //                                  //
+  if (_WindowType==INA_WINDOW_SLIDING &&                                      // Limited by the buffer            //
+      _WindowSamples>INA_STATISTICS_WINDOW_SIZE)                              //                                  //
+    _WindowSamples = INA_STATISTICS_WINDOW_SIZE;                              //                                  //
+  _Decimation    = decimation==0 ? 1 : decimation;                            //                                  //
+  reset();                                                                    //                                  //
+} // of method setWindow()                                                    //                                  //
+/*******************************************************************************************************************
+** Method reset discards the window being filled, any partly decimated sample and the unread results              **
+*******************************************************************************************************************/
+void INA226_Statistics::reset() {                                             // Start an empty window            //
+  inaInterruptLock lock;                                                      // Stop add() while clearing        //
+  _Count          = 0;                                                        //                                  //
+  _Oldest         = 0;                                                        //                                  //
+  _Decimated      = 0;                                                        //                                  //
+  _CompletedCount = 0;                                                        //                                  //
+  _Unread         = false;                                                    //                                  //
+  memset(_DecimationSum,0,sizeof(_DecimationSum));                            //                                  //
+} // of method reset()                                                        //                                  //
+/*******************************************************************************************************************
+** Method sample reads the device's results if a conversion is ready and adds them. Returns true if a conversion  **
+** was read. It is called from loop(), or from the ALERT pin interrupt handler with the conversion ready alert    **
+** enabled.                                                                                                       **
+*******************************************************************************************************************/
+bool INA226_Statistics::sample() {                                            // Add conversion if it is ready    //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  inaRawSample raw;                                                           // Raw register values              //
+  if (!_INA.readResults(ina,raw,true)) return false;                          // No new conversion                //
+  add(raw);                                                                   //                                  //
+  return true;                                                                //                                  //
+} // of method sample()                                                       //                                  //
+/*******************************************************************************************************************
+** Method add adds the bus voltage, shunt voltage and current registers of one conversion. When "decimation"      **
+** conversions have been added their average becomes the next sample of the window. Returns true when a tumbling  **
+** window is complete or a full sliding window has moved on, so that read() has new results.                      **
+*******************************************************************************************************************/
+bool INA226_Statistics::add(const inaRawSample &raw) {                        // Add one conversion               //
+  int32_t values[INA_STATISTICS_CHANNELS] = {raw.bus,raw.shunt,raw.current};  // Channels in order                //
+  _Timestamp = raw.timestamp;                                                 //                                  //
+  if (_Decimation>1) {                                                        // Average several conversions      //
+    for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++)                            //                                  //
+      _DecimationSum[i] += values[i];                                         //                                  //
+    if (++_Decimated<_Decimation) return false;                               // Sample isn't complete yet        //
+    for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++) {                          //                                  //
+      values[i]         = _DecimationSum[i]/_Decimation;                      //                                  //
+      _DecimationSum[i] = 0;                                                  //                                  //
+    } // of for-next each channel                                             //                                  //
+    _Decimated = 0;                                                           //                                  //
+  } // of if-then decimation                                                  //                                  //
+  if (_WindowType==INA_WINDOW_TUMBLING) {                                     // Tumbling window                  //
+    insert(values);                                                           //                                  //
+    if (_Count<_WindowSamples) return false;                                  // Window isn't full yet            //
+    memcpy(_Completed,_Running,sizeof(_Completed));                           // Keep results for read()          //
+    _CompletedCount = _Count;                                                 //                                  //
+    _CompletedTime  = _Timestamp;                                             //                                  //
+    _Count          = 0;                                                      // Start the next window            //
+    _Unread         = true;                                                   //                                  //
+    return true;                                                              //                                  //
+  } // of if-then tumbling window                                             //                                  //
+  if (_Count<_WindowSamples) {                                                // Sliding window filling up        //
+    for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++)                            //                                  //
+      _Window[_Count][i] = values[i];                                         //                                  //
+    insert(values);                                                           //                                  //
+    _Unread = _Count==_WindowSamples;                                         //                                  //
+    return _Unread;                                                           //                                  //
+  } // of if-then window not full                                             //                                  //
+  int32_t oldest[INA_STATISTICS_CHANNELS];                                    // Sample leaving the window        //
+  bool    extreme = false;                                                    // It was a minimum or maximum      //
+  for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++) {                            //                                  //
+    oldest[i]            = _Window[_Oldest][i];                               //                                  //
+    _Window[_Oldest][i]  = values[i];                                         //                                  //
+    extreme             |= oldest[i]==_Running[i].minimum ||                  //                                  //
+                           oldest[i]==_Running[i].maximum;                    //                                  //
+  } // of for-next each channel                                               //                                  //
+  _Oldest = (_Oldest+1)%_WindowSamples;                                       //                                  //
+  remove(oldest);                                                             //                                  //
+  insert(values);                                                             //                                  //
+  if (extreme || _Oldest==0) recompute();                                     // See method recompute()           //
+  _Unread = true;                                                             //                                  //
+  return true;                                                                //                                  //
+} // of method add()                                                          //                                  //
+/*******************************************************************************************************************
+** Method insert adds a sample to the running window using Welford's method. The mean is kept in 1/256ths of a    **
+** register LSB and the sum of squared deviations in 1/65536ths, so rounding is negligible. With 16-bit registers **
+** the sum can't overflow 63 bits in a window of 65535 samples.                                                   **
+*******************************************************************************************************************/
+void INA226_Statistics::insert(const int32_t *values) {                       // Add a sample to the window       //
+  _Count++;                                                                   //                                  //
+  for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++) {                            //                                  //
+    inaWelford &welford = _Running[i];                                        //                                  //
+    int32_t     scaled  = values[i]*256;                                      // Value in 1/256 LSB               //
+    if (_Count==1) {                                                          // First sample of a window         //
+      welford.minimum = values[i];                                            //                                  //
+      welford.maximum = values[i];                                            //                                  //
+      welford.mean    = scaled;                                               //                                  //
+      welford.m2      = 0;                                                    //                                  //
+      continue;                                                               //                                  //
+    } // of if-then first sample                                              //                                  //
+    if (values[i]<welford.minimum) welford.minimum = values[i];               //                                  //
+    if (values[i]>welford.maximum) welford.maximum = values[i];               //                                  //
+    int32_t delta = scaled-welford.mean;                                      //                                  //
+    welford.mean += delta/_Count;                                             //                                  //
+    welford.m2   += (int64_t)delta*(scaled-welford.mean);                     //                                  //
+  } // of for-next each channel                                               //                                  //
+} // of method insert()                                                       //                                  //
+/*******************************************************************************************************************
+** Method remove takes a sample out of the running window, reversing Welford's update. The minimum and maximum    **
+** can't be reversed, add() calls recompute() when the sample removed was one of them. Removing the only sample   **
+** of a one-sample window leaves nothing to reverse, insert() then starts the channels again from the new sample. **
+*******************************************************************************************************************/
+void INA226_Statistics::remove(const int32_t *values) {                       // Take a sample out of the window  //
+  if (--_Count==0) return;                                                    // Window of one, insert() restarts //
+  for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++) {                            //                                  //
+    inaWelford &welford = _Running[i];                                        //                                  //
+    int32_t     scaled  = values[i]*256;                                      // Value in 1/256 LSB               //
+    int32_t     delta   = scaled-welford.mean;                                //                                  //
+    welford.mean -= delta/_Count;                                             //                                  //
+    welford.m2   -= (int64_t)delta*(scaled-welford.mean);                     //                                  //
+    if (welford.m2<0) welford.m2 = 0;                                         // Rounding of a tiny variance      //
+  } // of for-next each channel                                               //                                  //
+} // of method remove()                                                       //                                  //
+/*******************************************************************************************************************
+** Method recompute computes the statistics of a full sliding window exactly from its buffer. It is called when   **
+** the minimum or maximum leaves the window and once every window length, so the rounding errors of the removals  **
+** can't build up. It costs a pass over the buffer, on average much less than one per sample.                     **
+*******************************************************************************************************************/
+void INA226_Statistics::recompute() {                                         // Exact values from the buffer     //
+  for(uint8_t i=0;i<INA_STATISTICS_CHANNELS;i++) {                            //                                  //
+    inaWelford &welford = _Running[i];                                        //                                  //
+    int32_t     sum     = 0;                                                  //                                  //
+    welford.minimum     = INT32_MAX;                                          //                                  //
+    welford.maximum     = INT32_MIN;                                          //                                  //
+    for(uint16_t j=0;j<_Count;j++) {                                          // Minimum, maximum and sum         //
+      int32_t value = _Window[j][i];                                          //                                  //
+      sum += value;                                                           //                                  //
+      if (value<welford.minimum) welford.minimum = value;                     //                                  //
+      if (value>welford.maximum) welford.maximum = value;                     //                                  //
+    } // of for-next each sample                                              //                                  //
+    welford.mean = (int64_t)sum*256/_Count;                                   //                                  //
+    welford.m2   = 0;                                                         //                                  //
+    for(uint16_t j=0;j<_Count;j++) {                                          // Squared deviations               //
+      int32_t delta = _Window[j][i]*256-welford.mean;                         //                                  //
+      welford.m2   += (int64_t)delta*delta;                                   //                                  //
+    } // of for-next each sample                                              //                                  //
+  } // of for-next each channel                                               //                                  //
+} // of method recompute()                                                    //                                  //
+/*******************************************************************************************************************
+** Method read returns the statistics of the last complete tumbling window, or of the current sliding window, and **
+** returns true if they are new since the last call. Interrupts are disabled only while the running values are    **
+** copied, the conversion to engineering units and the square roots are done afterwards.                          **
+*******************************************************************************************************************/
+bool INA226_Statistics::read(inaStatistics &stats) {                          // Statistics of the latest window  //
+  inaWelford welford[INA_STATISTICS_CHANNELS];                                // Copy of the values               //
+  bool       unread;                                                          // New since the last call          //
+  {                                                                           //                                  //
+    inaInterruptLock lock;                                                    // Stop add() while copying         //
+    bool sliding = _WindowType==INA_WINDOW_SLIDING;                           //                                  //
+    memcpy(welford,sliding ? _Running : _Completed,sizeof(welford));          //                                  //
+    stats.samples   = sliding ? _Count     : _CompletedCount;                 //                                  //
+    stats.timestamp = sliding ? _Timestamp : _CompletedTime;                  //                                  //
+    unread          = _Unread;                                                //                                  //
+    _Unread         = false;                                                  //                                  //
+  } // of interrupt lock                                                      //                                  //
+  summarize(welford[0],0,stats.samples,stats.busMilliVolts);                  //                                  //
+  summarize(welford[1],1,stats.samples,stats.shuntMicroVolts);                //                                  //
+  summarize(welford[2],2,stats.samples,stats.busMicroAmps);                   //                                  //
+  return unread;                                                              //                                  //
+} // of method read()                                                         //                                  //
+/*******************************************************************************************************************
+** Method summarize converts the values of one channel to engineering units with the same LSBs as the getters.    **
+** The variance is the population variance of the window and the RMS is computed from it and the mean, as RMS^2 = **
+** mean^2 + variance, so no sum of squares is needed.                                                             **
+*******************************************************************************************************************/
+void INA226_Statistics::summarize(const inaWelford &welford,                  // Convert a channel to             //
+                                  const uint8_t channel,                      // engineering units                //
+                                  const uint16_t count,                       //                                  //
+                                  inaChannelStats &stats) {                   //                                  //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  uint32_t multiplier, divisor;                                               // 1/256 LSB to units               //
+  switch (channel) {                                                          //                                  //
+    case 0:  multiplier = INA_BUS_VOLTAGE_LSB;   divisor = 100UL*256;    break;// Bus voltage in mV               //
+    case 1:  multiplier = INA_SHUNT_VOLTAGE_LSB; divisor = 10UL*256;     break;// Shunt voltage in uV             //
+    default: multiplier = ina.current_LSB;       divisor = 1000UL*256;        // Current in uA                    //
+  } // of switch channel                                                      //                                  //
+  if (count==0) {                                                             // Nothing in the window            //
+    memset(&stats,0,sizeof(stats));                                           //                                  //
+    return;                                                                   //                                  //
+  } // of if-then empty window                                                //                                  //
+  uint64_t variance = welford.m2/count;                                       // In 1/65536 LSB^2                 //
+  stats.minimum  = mulDiv((int64_t)welford.minimum*256,multiplier,divisor);   //                                  //
+  stats.maximum  = mulDiv((int64_t)welford.maximum*256,multiplier,divisor);   //                                  //
+  stats.mean     = mulDiv(welford.mean,multiplier,divisor);                   //                                  //
+  stats.variance = mulDiv(mulDiv(variance,multiplier,divisor),multiplier,     // Scaled twice                     //
+                          divisor);                                           //                                  //
+  stats.rms      = mulDiv(squareRoot((int64_t)welford.mean*welford.mean+      // In 1/256 LSB                     //
+                                     variance),multiplier,divisor);           //                                  //
+} // of method summarize()                                                    //                                  //
+/*******************************************************************************************************************
+** Function putWord stores a 16-bit value little-endian and returns the position after it                         **
+*******************************************************************************************************************/
+static uint8_t putWord(uint8_t *frame, uint8_t position, const uint16_t value) {// Store 2 bytes                  //
+  frame[position++] = value;                                                  //                                  //
+  frame[position++] = value>>8;                                               //                                  //
+  return position;                                                            //                                  //
+} // of function putWord()                                                    //                                  //
+/*******************************************************************************************************************
+** Function putLong stores a 32-bit value little-endian and returns the position after it                         **
+*******************************************************************************************************************/
+static uint8_t putLong(uint8_t *frame, uint8_t position, const uint32_t value) {// Store 4 bytes                  //
+  position = putWord(frame,position,value);                                   //                                  //
+  return putWord(frame,position,value>>16);                                   //                                  //
+} // of function putLong()                                                    //                                  //
+/*******************************************************************************************************************
+** Method seal appends the CRC-8 of the first "size"-1 bytes to a frame and returns the frame size                **
+*******************************************************************************************************************/
+uint8_t INA226_Telemetry::seal(uint8_t *frame, const uint8_t size) {          // Append the CRC                   //
+  uint8_t crc = 0;                                                            //                                  //
+  for(uint8_t i=0;i<size-1;i++) crc = INA226_Class::crc8(crc,frame[i]);       //                                  //
+  frame[size-1] = crc;                                                        //                                  //
+  return size;                                                                //                                  //
+} // of method seal()                                                         //                                  //
+/*******************************************************************************************************************
+** INA226_Telemetry class constructor                                                                             **
+*******************************************************************************************************************/
+INA226_Telemetry::INA226_Telemetry(INA226_Class &ina, Print &output) :        // Class constructor                //
+  _INA(ina), _Output(output) {                                                //                                  //
+  memset(_Last,0,sizeof(_Last));                                              //                                  //
+  memset(_Sequence,0,sizeof(_Sequence));                                      //                                  //
+  memset(_SinceKey,INA_FRAME_KEY_INTERVAL,sizeof(_SinceKey));                 // Start with key frames            //
+} // of class constructor                                                     //                                  //
+/*******************************************************************************************************************
+** Method begin sends a header frame for every device so that the decoder knows their LSBs, and makes the next    **
+** frame of every device a key frame. It is called after INA226_Class::begin() and again whenever the calibration **
+** or the settings change, or the receiver might have missed the headers.                                         **
+*******************************************************************************************************************/
+void INA226_Telemetry::begin() {                                              // Send the header frames           //
+  uint8_t frame[INA_FRAME_MAX_SIZE];                                          //                                  //
+  for(uint8_t i=0;i<_INA._DeviceCount;i++) {                                  // Loop for each device found       //
+    _Output.write(frame,encodeHeader(i,frame));                               //                                  //
+    _SinceKey[i] = INA_FRAME_KEY_INTERVAL;                                    //                                  //
+  } // for-next each device loop                                              //                                  //
+} // of method begin()                                                        //                                  //
+/*******************************************************************************************************************
+** Method sample reads the device's results if a conversion is ready and sends them. Returns true if a frame was  **
+** sent.                                                                                                          **
+*******************************************************************************************************************/
+bool INA226_Telemetry::sample(const uint8_t deviceNumber) {                   // Send conversion if it is ready   //
+  inaRawSample raw;                                                           // Raw register values              //
+  uint8_t      frame[INA_FRAME_MAX_SIZE];                                     //                                  //
+  raw.device = deviceNumber%_INA._DeviceCount;                                //                                  //
+  if (!_INA.readResults(_INA._Devices[raw.device],raw,true)) return false;    // No new conversion                //
+  _Output.write(frame,encode(raw,frame));                                     //                                  //
+  return true;                                                                //                                  //
+} // of method sample()                                                       //                                  //
+/*******************************************************************************************************************
+** Method encode stores the frame for "raw" in "frame", which has to hold INA_FRAME_MAX_SIZE bytes, and returns   **
+** its size. The sample becomes the base of the device's next delta frame, so every frame encoded has to be sent. **
+*******************************************************************************************************************/
+uint8_t INA226_Telemetry::encode(const inaRawSample &raw, uint8_t *frame) {   // Encode a sample frame            //
+  uint8_t       device  = raw.device%INA_MAX_DEVICES;                         //                                  //
+  inaRawSample &last    = _Last[device];                                      //                                  //
+  uint32_t      elapsed = raw.timestamp-last.timestamp;                       //                                  //
+  int32_t       delta[4] = {(int32_t)raw.bus-last.bus,raw.shunt-last.shunt,   // Changes of the registers         //
+                            raw.current-last.current,                         //                                  //
+                            (int32_t)raw.power-last.power};                   //                                  //
+  bool          fits    = _SinceKey[device]<INA_FRAME_KEY_INTERVAL &&         // Delta frame possible             //
+                          elapsed<=UINT16_MAX;                                //                                  //
+  for(uint8_t i=0;i<4;i++) fits &= delta[i]>=INT8_MIN && delta[i]<=INT8_MAX;  //                                  //
+  frame[0] = INA_FRAME_SYNC;                                                  //                                  //
+  frame[2] = ++_Sequence[device];                                             //                                  //
+  last     = raw;                                                             // Base of the next delta           //
+  if (fits) {                                                                 //                                  //
+    _SinceKey[device]++;                                                      //                                  //
+    frame[1] = INA_FRAME_DELTA|device;                                        //                                  //
+    uint8_t position = putWord(frame,3,elapsed);                              //                                  //
+    for(uint8_t i=0;i<4;i++) frame[position++] = (int8_t)delta[i];            //                                  //
+    return seal(frame,INA_FRAME_DELTA_SIZE);                                  //                                  //
+  } // of if-then delta frame                                                 //                                  //
+  _SinceKey[device] = 0;                                                      //                                  //
+  frame[1] = INA_FRAME_KEY|device;                                            //                                  //
+  uint8_t position = putLong(frame,3,raw.timestamp);                          //                                  //
+  position = putWord(frame,position,raw.bus);                                 //                                  //
+  position = putWord(frame,position,raw.shunt);                               //                                  //
+  position = putWord(frame,position,raw.current);                             //                                  //
+  putWord(frame,position,raw.power);                                          //                                  //
+  return seal(frame,INA_FRAME_KEY_SIZE);                                      //                                  //
+} // of method encode()                                                       //                                  //
+/*******************************************************************************************************************
+** Method encodeHeader stores the header frame of a device in "frame" and returns its size                        **
+*******************************************************************************************************************/
+uint8_t INA226_Telemetry::encodeHeader(const uint8_t deviceNumber,            // Encode a header frame            //
+                                       uint8_t *frame) {                      //                                  //
+  uint8_t       device = deviceNumber%_INA._DeviceCount;                      //                                  //
+  const inaDet &ina    = _INA._Devices[device];                               // Reference device table entry     //
+  frame[0] = INA_FRAME_SYNC;                                                  //                                  //
+  frame[1] = INA_FRAME_HEADER|device;                                         //                                  //
+  frame[2] = ina.address;                                                     //                                  //
+  uint8_t position = putWord(frame,3,ina.configuration);                      //                                  //
+  position = putWord(frame,position,ina.calibration);                         //                                  //
+  position = putLong(frame,position,ina.current_LSB);                         //                                  //
+  putLong(frame,position,ina.power_LSB);                                      //                                  //
+  return seal(frame,INA_FRAME_HEADER_SIZE);                                   //                                  //
+} // of method encodeHeader()                                                 //                                  //
+/*******************************************************************************************************************
+** INA226_DutyCycle class constructor                                                                             **
+*******************************************************************************************************************/
+INA226_DutyCycle::INA226_DutyCycle(INA226_Class &ina,                         // Class constructor                //
+                                   const uint8_t deviceNumber) :              //                                  //
+  _INA(ina), _DeviceNumber(deviceNumber) {}                                   //                                  //
+/*******************************************************************************************************************
+** Method begin powers the device down, or puts it into the triggered mode when "powerDown" is false, and enables **
+** the conversion ready alert when the ALERT pin is used. The first conversion is triggered by the next call to   **
+** tick().                                                                                                        **
+*******************************************************************************************************************/
+void INA226_DutyCycle::begin(const uint32_t periodMicros, const uint8_t mode, // Start duty cycled sampling       //
+                             const bool alertPin, const bool powerDown) {     //                                  //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  if (_Period==0) _SavedMode = ina.operatingMode;                             // Restored by end()                //
+  _Mode       = mode&INA_CONFIG_MODE_MASK&~4;                                 // Only the triggered modes         //
+  _Period     = periodMicros;                                                 //                                  //
+  _AlertPin   = alertPin;                                                     //                                  //
+  _PowerDown  = powerDown;                                                    //                                  //
+  _Pending    = false;                                                        //                                  //
+  _Alerted    = false;                                                        //                                  //
+  _INA.setMode(powerDown ? INA_MODE_POWER_DOWN : _Mode,_DeviceNumber);        // Resting state of the device      //
+  if (alertPin) _INA.setAlertPinOnConversion(true,_DeviceNumber);             // ALERT on conversion ready        //
+  _Duration   = _INA.conversionMicros((ina.configuration&                     // Duration of a triggered          //
+                                       ~INA_CONFIG_MODE_MASK)|_Mode);         // conversion                       //
+  _NextDue    = micros();                                                     // First one is due at once         //
+} // of method begin()                                                        //                                  //
+/*******************************************************************************************************************
+** Method end stops the duty cycle and writes back the mode the device had before the first begin()               **
+*******************************************************************************************************************/
+void INA226_DutyCycle::end() {                                                // Back to the previous mode        //
+  _Pending = false;                                                           //                                  //
+  _Period  = 0;                                                               // Not running                      //
+  _INA.setMode(_SavedMode,_DeviceNumber);                                     //                                  //
+} // of method end()                                                          //                                  //
+/*******************************************************************************************************************
+** Method alertISR marks the conversion as finished without any bus access, so it can be called from the          **
+** interrupt handler of the ALERT pin                                                                             **
+*******************************************************************************************************************/
+void INA226_DutyCycle::alertISR() {                                           // Call from the ALERT interrupt    //
+  _Alerted = true;                                                            //                                  //
+} // of method alertISR()                                                     //                                  //
+/*******************************************************************************************************************
+** Method tick triggers a conversion when the next one is due and reads the results once it has finished. The     **
+** trigger is a single write of the shadow configuration with the triggered mode. The end of the conversion is    **
+** known from alertISR() or, when polling, from the conversion ready flag, which is only read after the expected  **
+** duration. The results are read without the checks of readSnapshot() since a triggered device makes just one    **
+** conversion. Returns true when "snapshot" holds a new result.                                                   **
+*******************************************************************************************************************/
+bool INA226_DutyCycle::tick(inaSnapshot &snapshot) {                          // Trigger or read when due         //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  uint32_t      now = micros();                                               //                                  //
+  if (!_Pending) {                                                            // Waiting for the next trigger     //
+    if ((int32_t)(now-_NextDue)<0) return false;                              // Not due yet                      //
+    _Alerted   = false;                                                       //                                  //
+    _INA.writeWord(INA_CONFIGURATION_REGISTER,                                // Start one conversion, this also  //
+                   (ina.configuration&~INA_CONFIG_MODE_MASK)|_Mode,           // clears the conversion ready flag //
+                   ina.address);                                              //                                  //
+    _Triggered = now;                                                         //                                  //
+    _Pending   = true;                                                        //                                  //
+    if (_INA._TransmissionStatus!=0) {                                        // Device didn't answer, try again  //
+      _Missed++;                                                              // in the next period               //
+      finish(now);                                                            //                                  //
+    } // of if-then trigger failed                                            //                                  //
+    return false;                                                             //                                  //
+  } // of if-then not triggered                                               //                                  //
+  uint32_t elapsed = now-_Triggered;                                          // Time since the trigger           //
+  bool     timeout = elapsed>2*_Duration+INA_CONVERSION_SLACK;                //                                  //
+  if (!_Alerted) {                                                            // Not signalled by the ALERT pin   //
+    if (elapsed<_Duration || (_AlertPin && !timeout)) return false;           // Too early to look                //
+    if (!(_INA.readMask(ina,true)&                                            // Check the conversion ready flag  //
+          INA_CONVERSION_READY_MASK) || _INA._TransmissionStatus!=0) {        //                                  //
+      if (!timeout) return false;                                             //                                  //
+      _Missed++;                                                              // Give up on this conversion       //
+      finish(now);                                                            //                                  //
+      return false;                                                           //                                  //
+    } // of if-then not ready                                                 //                                  //
+  } // of if-then no alert                                                    //                                  //
+  inaRawSample raw;                                                           // Raw register values              //
+  raw.timestamp = micros();                                                   // Time of the reading              //
+  raw.shunt     = _INA.readWord(INA_SHUNT_VOLTAGE_REGISTER,ina.address,true); // Read all result registers        //
+  raw.bus       = _INA.readWord(INA_BUS_VOLTAGE_REGISTER,ina.address,true);   //                                  //
+  raw.power     = _INA.readWord(INA_POWER_REGISTER,ina.address,true);         //                                  //
+  raw.current   = _INA.readWord(INA_CURRENT_REGISTER,ina.address,true);       //                                  //
+  snapshot.conversionReady = true;                                            //                                  //
+  snapshot.timestamp       = raw.timestamp;                                   //                                  //
+  snapshot.busMilliVolts   = _INA.busToMilliVolts(raw.bus);                   // Convert to engineering units     //
+  snapshot.shuntMicroVolts = _INA.shuntToMicroVolts(raw.shunt);               //                                  //
+  snapshot.busMicroAmps    = _INA.currentToMicroAmps(raw.current,ina);        //                                  //
+  snapshot.busMicroWatts   = _INA.powerToMicroWatts(raw.power,ina);           //                                  //
+  _Cycles++;                                                                  // Statistics                       //
+  _LatencySum += micros()-_Triggered;                                         //                                  //
+  finish(now);                                                                //                                  //
+  return true;                                                                //                                  //
+} // of method tick()                                                         //                                  //
+/*******************************************************************************************************************
+** Method finish ends a cycle. In power-down mode the shadow configuration is written, which powers the device    **
+** down and clears the conversion ready flag and with it the ALERT pin, otherwise that is left to the next        **
+** trigger. The next trigger stays on the period grid unless whole periods have been missed.                      **
+*******************************************************************************************************************/
+void INA226_DutyCycle::finish(const uint32_t now) {                           // Power down, schedule next        //
+  const inaDet &ina = _INA._Devices[_DeviceNumber%_INA._DeviceCount];         // Reference device table entry     //
+  if (_PowerDown)                                                             // Back to power-down               //
+    _INA.writeWord(INA_CONFIGURATION_REGISTER,ina.configuration,ina.address); //                                  //
+  _Pending  = false;                                                          //                                  //
+  _Alerted  = false;                                                          //                                  //
+  _NextDue += _Period;                                                        // Stay on the period grid          //
+  if ((int32_t)(now-_NextDue)>=0) _NextDue = now+_Period;                     // Resynchronize when behind        //
+} // of method finish()                                                       //                                  //
+/*******************************************************************************************************************
+** Method getMicrosToNext returns how long the sketch can sleep before tick() needs to be called again: until the **
+** next trigger, until the conversion has finished or, when the ALERT pin is used, until the timeout unless the   **
+** interrupt wakes it up earlier. 0 means tick() should be called now.                                            **
+*******************************************************************************************************************/
+uint32_t INA226_DutyCycle::getMicrosToNext() {                                // Time the sketch can sleep        //
+  uint32_t now = micros();                                                    //                                  //
+  int32_t  remaining;                                                         // Until the next event             //
+  if (!_Pending) remaining = _NextDue-now;                                    // Next trigger                     //
+  else if (_Alerted) remaining = 0;                                           // Results can be read              //
+  else remaining = _Triggered+(_AlertPin ? 2*_Duration+INA_CONVERSION_SLACK : // Timeout or end of conversion     //
+                               _Duration)-now;                                //                                  //
+  return remaining>0 ? remaining : 0;                                         //                                  //
+} // of method getMicrosToNext()                                              //                                  //
+/*******************************************************************************************************************
+** Method getStats returns the counters, the mean time from trigger to snapshot and the estimated duty cycle of   **
+** the sensor, which is the conversion time over the period in parts per million and 1000000 when it never rests  **
+*******************************************************************************************************************/
+void INA226_DutyCycle::getStats(inaDutyStats &stats) {                        // Counters and duty cycle          //
+  stats.cycles           = _Cycles;                                           //                                  //
+  stats.missed           = _Missed;                                           //                                  //
+  stats.conversionMicros = _Duration;                                         //                                  //
+  stats.dutyCyclePPM     = _Period>_Duration ?                                //                                  //
+                           (uint64_t)_Duration*1000000/_Period : 1000000;     //                                  //
+  stats.averageLatency   = _Cycles>0 ? _LatencySum/_Cycles : 0;               //                                  //
+} // of method getStats()                                                     //----------------------------------//
@@ -33,6 +33,23 @@
 **                                                                                                                **
 ** Vers.  Date       Developer                     Comments                                                       **
 ** ====== ========== ============================= ============================================================== **
+** 1.1.0  2026-10-16 https://github.com/SV-Zanshin BEHAVIOR CHANGE: getBusMicroAmps(), readSnapshot() and all     **
+**                                                 classes return current in uA, before they returned 1/100 of    **
+**                                                 it. Power is unchanged                                         **
+** 1.0.19 2026-10-16 https://github.com/SV-Zanshin INA226_DutyCycle one-shot sampling, single write retrigger,    **
+** getMode() device fix                                                                                           **
+** 1.0.18 2026-10-16 https://github.com/SV-Zanshin Pluggable I2C transport, selectable TwoWire, FM+ and HS-mode   **
+** 1.0.17 2026-10-16 https://github.com/SV-Zanshin Optional I2C counters and API timing, debug_Mode off by        **
+** default                                                                                                        **
+** 1.0.16 2026-10-16 https://github.com/SV-Zanshin INA226_Telemetry binary frames, decoder in extras/host         **
+** 1.0.15 2026-10-16 https://github.com/SV-Zanshin INA226_Statistics windowed min/max/mean/variance/RMS           **
+** 1.0.14 2026-10-16 https://github.com/SV-Zanshin INA226_Scheduler services many devices by conversion deadline  **
+** 1.0.13 2026-10-16 https://github.com/SV-Zanshin INA226_Accumulator for charge and energy from raw registers    **
+** 1.0.12 2026-10-16 https://github.com/SV-Zanshin Alert limit register and limit functions in mA, mV and mW      **
+** 1.0.11 2026-10-16 https://github.com/SV-Zanshin Shadowed config and mask registers, beginConfig()/commit()     **
+** 1.0.10 2026-10-16 https://github.com/SV-Zanshin Versioned and checksummed EEPROM topology record, fastBegin()  **
+** 1.0.9  2026-10-16 https://github.com/SV-Zanshin INA226_Fixed template with compile-time calibration, fix guard **
+** 1.0.8  2026-10-16 https://github.com/SV-Zanshin Device table held in RAM, EEPROM now optional save/restore     **
 ** 1.0.7  2018-06-08 https://github.com/SV-Zanshin https://github.com/SV-Zanshin/INA226/issues/14. Missing calls  **
 **                                                 EEPROM.Get() for device number caused errors sporadic errors   **
 ** 1.0.6  2018-06-01 https://github.com/SV-Zanshin https://github.com/SV-Zanshin/INA226/issues/12. Add getMode()  **
@@ -52,8 +69,14 @@
 **                                                                                                                **
 *******************************************************************************************************************/
 #include "Arduino.h"                                                          // Arduino data type definitions    //
-#ifndef INA226_Class_h                                                        // Guard code definition            //
-  #define debug_Mode                                                          // Comment out when not needed      //
+#include <Wire.h>                                                             // TwoWire of the default transport //
+#ifndef INA226__Class_h                                                       // Guard code definition            //
+  /*****************************************************************************************************************
+  ** Optional code, enabled by uncommenting the definition here or with a compiler flag for the whole build, as   **
+  ** the library is compiled separately from the sketch. Nothing of it is compiled in otherwise.                  **
+  *****************************************************************************************************************/
+  // #define debug_Mode                                                       // Show calibration and raw values  //
+  // #define INA_INSTRUMENTATION                                              // Count I2C traffic and time calls //
   #define INA226__Class_h                                                     // Define the name inside guard code//
   /*****************************************************************************************************************
   ** Declare structures used in the class                                                                         **
@@ -64,7 +87,123 @@
     uint32_t current_LSB;                                                     // Amperage LSB                     //
     uint32_t power_LSB;                                                       // Wattage LSB                      //
     uint8_t  operatingMode;                                                   // Default continuous mode operation//
+    uint16_t configuration;                                                   // Configuration register contents  //
+    uint16_t maskEnable;                                                      // Writable mask/enable bits        //
+    uint16_t alertLimit;                                                      // Alert limit register contents    //
   } inaDet; // of structure                                                   //                                  //
+  typedef struct {                                                            // Coherent set of readings         //
+    uint32_t timestamp;                                                       // micros() value when read         //
+    uint16_t busMilliVolts;                                                   // Bus voltage in mV                //
+    int32_t  shuntMicroVolts;                                                 // Shunt voltage in uV              //
+    int32_t  busMicroAmps;                                                    // Current in uA                    //
+    int32_t  busMicroWatts;                                                   // Power in uW                      //
+    bool     conversionReady;                                                 // New conversion since last read   //
+  } inaSnapshot; // of structure                                              //                                  //
+  typedef struct {                                                            // State of a started conversion    //
+    uint32_t started;                                                         // micros() value at start          //
+    uint32_t duration;                                                        // Expected duration in us          //
+    bool     pending;                                                         // Conversion is being waited for   //
+  } inaConversion; // of structure                                            //                                  //
+  typedef void (*inaCallback)(const uint8_t deviceNumber);                    // Called when conversion is ready  //
+  #ifndef INA_SAMPLE_BUFFER_SIZE                                              // Allow override at compile time   //
+    #define INA_SAMPLE_BUFFER_SIZE 16                                         // Samples, must be a power of 2    //
+  #endif                                                                      // of if-then buffer size set       //
+  typedef struct {                                                            // Sample as captured in the ISR    //
+    uint32_t timestamp;                                                       // micros() value when read         //
+    uint8_t  device;                                                          // Device number                    //
+    uint16_t bus;                                                             // Bus voltage register             //
+    int16_t  shunt;                                                           // Shunt voltage register           //
+    int16_t  current;                                                         // Current register                 //
+    uint16_t power;                                                           // Power register                   //
+  } inaRawSample; // of structure                                             //                                  //
+  typedef struct {                                                            // Sample in engineering units      //
+    uint32_t timestamp;                                                       // micros() value when read         //
+    uint8_t  device;                                                          // Device number                    //
+    uint16_t busMilliVolts;                                                   // Bus voltage in mV                //
+    int32_t  shuntMicroVolts;                                                 // Shunt voltage in uV              //
+    int32_t  busMicroAmps;                                                    // Current in uA                    //
+    int32_t  busMicroWatts;                                                   // Power in uW                      //
+  } inaSample; // of structure                                                //                                  //
+  typedef struct {                                                            // Accumulated charge and energy    //
+    int64_t  microAmpHours;                                                   // Charge, negative when charging   //
+    int64_t  microWattHours;                                                  // Energy, signed like the charge   //
+    uint32_t seconds;                                                         // Integrated time                  //
+    uint32_t conversions;                                                     // Conversions integrated           //
+  } inaEnergy; // of structure                                                //                                  //
+  #ifndef INA_STATISTICS_WINDOW_SIZE                                          // Allow override at compile time   //
+    #define INA_STATISTICS_WINDOW_SIZE 32                                     // Longest sliding window           //
+  #endif                                                                      // of if-then window size set       //
+  typedef struct {                                                            // Running statistics of a channel  //
+    int32_t  minimum;                                                         // Smallest raw value               //
+    int32_t  maximum;                                                         // Largest raw value                //
+    int32_t  mean;                                                            // Raw mean times 256               //
+    int64_t  m2;                                                              // Squared deviations times 65536   //
+  } inaWelford; // of structure                                               //                                  //
+  typedef struct {                                                            // Statistics of a channel          //
+    int32_t  minimum;                                                         // Smallest value                   //
+    int32_t  maximum;                                                         // Largest value                    //
+    int32_t  mean;                                                            // Mean value                       //
+    uint64_t variance;                                                        // Population variance, unit^2      //
+    int32_t  rms;                                                             // Root mean square                 //
+  } inaChannelStats; // of structure                                          //                                  //
+  typedef struct {                                                            // Statistics of a window           //
+    uint32_t        timestamp;                                                // micros() of the last sample      //
+    uint16_t        samples;                                                  // Samples in the window            //
+    inaChannelStats busMilliVolts;                                            // Bus voltage in mV                //
+    inaChannelStats shuntMicroVolts;                                          // Shunt voltage in uV              //
+    inaChannelStats busMicroAmps;                                             // Current in uA                    //
+  } inaStatistics; // of structure                                            //                                  //
+  #ifdef INA_INSTRUMENTATION                                                  // Only when instrumented           //
+    const uint8_t INA_REGISTER_SLOTS    =  9;                                 // Registers 0-7 and the ID ones    //
+    const uint8_t INA_HISTOGRAM_BUCKETS = 16;                                 // Powers of 2 from 1us to 16ms+    //
+    const uint8_t INA_API_BEGIN         =  0;                                 // begin() and fastBegin()          //
+    const uint8_t INA_API_BUS           =  1;                                 // getBusMilliVolts()               //
+    const uint8_t INA_API_SHUNT         =  2;                                 // getShuntMicroVolts()             //
+    const uint8_t INA_API_CURRENT       =  3;                                 // getBusMicroAmps()                //
+    const uint8_t INA_API_POWER         =  4;                                 // getBusMicroWatts()               //
+    const uint8_t INA_API_SNAPSHOT      =  5;                                 // readSnapshot()                   //
+    const uint8_t INA_API_WAIT          =  6;                                 // waitForConversion()              //
+    const uint8_t INA_API_POLL          =  7;                                 // pollConversion()                 //
+    const uint8_t INA_API_CONFIG        =  8;                                 // Setters, commit() and reset()    //
+    const uint8_t INA_API_COUNT         =  9;                                 // Number of timed API groups       //
+    typedef struct {                                                          // I2C traffic counters             //
+      uint32_t transactions;                                                  // START to STOP, not repeated START//
+      uint32_t bytes;                                                         // Bytes incl. address, successful  //
+      uint32_t nacks;                                                         // Address or data not acknowledged //
+      uint32_t timeouts;                                                      // Bus timed out                    //
+      uint32_t errors;                                                        // Other errors and short reads     //
+    } inaBusCounters; // of structure                                         //                                  //
+    typedef struct {                                                          // Duration histogram of an API     //
+      uint16_t buckets[INA_HISTOGRAM_BUCKETS];                                // Bucket n counts calls taking     //
+    } inaHistogram; // of structure                                           // 2^(n-1) to 2^n-1 us              //
+  #endif                                                                      // of if-then instrumentation       //
+  typedef struct {                                                            // Schedule of one device           //
+    uint32_t deadline;                                                        // micros() when next one is due    //
+    uint32_t firstSample;                                                     // micros() of first sample         //
+    uint32_t lastSample;                                                      // micros() of latest sample        //
+    uint32_t samples;                                                         // Samples taken                    //
+    uint32_t missed;                                                          // Conversions overwritten unread   //
+    uint32_t totalSlip;                                                       // Sum of lateness in us            //
+    uint32_t maxSlip;                                                         // Worst lateness in us             //
+  } inaSchedule; // of structure                                              //                                  //
+  typedef struct {                                                            // Scheduler statistics             //
+    uint32_t samples;                                                         // Samples taken                    //
+    uint32_t milliHertz;                                                      // Achieved sample rate             //
+    uint32_t conversionMicros;                                                // Scheduled period in us           //
+    uint32_t averageSlip;                                                     // Mean lateness in us              //
+    uint32_t maxSlip;                                                         // Worst lateness in us             //
+    uint32_t missed;                                                          // Conversions overwritten unread   //
+  } inaScheduleStats; // of structure                                         //                                  //
+  typedef struct {                                                            // Duty cycle statistics            //
+    uint32_t cycles;                                                          // Snapshots read                   //
+    uint32_t missed;                                                          // Triggers without a result        //
+    uint32_t conversionMicros;                                                // Duration of one conversion       //
+    uint32_t dutyCyclePPM;                                                    // Sensor active time, ppm          //
+    uint32_t averageLatency;                                                  // Trigger to snapshot in us        //
+  } inaDutyStats; // of structure                                             //                                  //
+  #ifndef INA_MAX_DEVICES                                                     // Allow override at compile time   //
+    #define INA_MAX_DEVICES 15                                                // Addresses 64-78 can be scanned   //
+  #endif                                                                      // of if-then INA_MAX_DEVICES set   //
   /*****************************************************************************************************************
   ** Declare constants used in the class                                                                          **
   *****************************************************************************************************************/
@@ -76,7 +215,11 @@
   const uint8_t  INA_CURRENT_REGISTER         =      4;                       //                                  //
   const uint8_t  INA_CALIBRATION_REGISTER     =      5;                       //                                  //
   const uint8_t  INA_MASK_ENABLE_REGISTER     =      6;                       //                                  //
+  const uint8_t  INA_ALERT_LIMIT_REGISTER     =      7;                       //                                  //
   const uint8_t  INA_MANUFACTURER_ID_REGISTER =   0xFE;                       //                                  //
+  const uint8_t  INA_UNKNOWN_POINTER          =   0xFF;                       // Register pointer isn't known     //
+  const uint16_t INA_MANUFACTURER_ID          = 0x5449;                       // "TI" in manufacturer register    //
+  const uint8_t  INA_TOPOLOGY_VERSION         =      3;                       // Layout of the EEPROM record      //
   const uint16_t INA_RESET_DEVICE             = 0x8000;                       // Write to configuration to reset  //
   const uint16_t INA_DEFAULT_CONFIGURATION    = 0x4127;                       // Default configuration register   //
   const uint16_t INA_BUS_VOLTAGE_LSB          =    125;                       // LSB in uV *100 1.25mV            //
@@ -84,8 +227,20 @@
   const uint16_t INA_CONFIG_AVG_MASK          = 0x0E00;                       // Bits 9-11                        //
   const uint16_t INA_CONFIG_BUS_TIME_MASK     = 0x01C0;                       // Bits 6-8                         //
   const uint16_t INA_CONFIG_SHUNT_TIME_MASK   = 0x0038;                       // Bits 3-5                         //
-  const uint16_t INA_CONVERSION_READY_MASK    = 0x0080;                       // Bit 4                            //
+  const uint16_t INA_CONVERSION_READY_MASK    = 0x0008;                       // Bit 3                            //
   const uint16_t INA_CONFIG_MODE_MASK         = 0x0007;                       // Bits 0-3                         //
+  const uint16_t INA_MASK_WRITABLE            = 0xFC03;                       // Alert function, APOL and LEN     //
+  const uint16_t INA_ALERT_NONE               = 0x0000;                       // No limit function armed          //
+  const uint16_t INA_ALERT_SHUNT_OVER         = 0x8000;                       // Bit 15, SOL, limit in mA         //
+  const uint16_t INA_ALERT_SHUNT_UNDER        = 0x4000;                       // Bit 14, SUL, limit in mA         //
+  const uint16_t INA_ALERT_BUS_OVER           = 0x2000;                       // Bit 13, BOL, limit in mV         //
+  const uint16_t INA_ALERT_BUS_UNDER          = 0x1000;                       // Bit 12, BUL, limit in mV         //
+  const uint16_t INA_ALERT_POWER_OVER         = 0x0800;                       // Bit 11, POL, limit in mW         //
+  const uint16_t INA_ALERT_CONVERSION_READY   = 0x0400;                       // Bit 10, CNVR                     //
+  const uint16_t INA_ALERT_FUNCTION_MASK      = 0xF800;                       // Bits 11-15, limit functions      //
+  const uint16_t INA_ALERT_FUNCTION_FLAG      = 0x0010;                       // Bit 4, AFF                       //
+  const uint16_t INA_ALERT_MATH_OVERFLOW      = 0x0004;                       // Bit 2, OVF                       //
+  const uint16_t INA_ALERT_LATCH              = 0x0001;                       // Bit 0, LEN                       //
   const uint8_t  INA_MODE_TRIGGERED_SHUNT     =   B001;                       // Triggered shunt, no bus          //
   const uint8_t  INA_MODE_TRIGGERED_BUS       =   B010;                       // Triggered bus, no shunt          //
   const uint8_t  INA_MODE_TRIGGERED_BOTH      =   B011;                       // Triggered bus and shunt          //
@@ -93,22 +248,99 @@
   const uint8_t  INA_MODE_CONTINUOUS_SHUNT    =   B101;                       // Continuous shunt, no bus         //
   const uint8_t  INA_MODE_CONTINUOUS_BUS      =   B110;                       // Continuous bus, no shunt         //
   const uint8_t  INA_MODE_CONTINUOUS_BOTH     =   B111;                       // Both continuous, default value   //
+  const uint8_t  INA_CONVERSION_IDLE          =      0;                       // No conversion has been started   //
+  const uint8_t  INA_CONVERSION_PENDING       =      1;                       // Conversion is still running      //
+  const uint8_t  INA_CONVERSION_READY         =      2;                       // Conversion results are ready     //
+  const uint8_t  INA_CONVERSION_TIMEOUT       =      3;                       // Device didn't finish in time     //
+  const uint16_t INA_CONVERSION_SLACK         =   1000;                       // Timeout margin in microseconds   //
+  const uint16_t INA_CONVERSION_POLL_MAX      =   1000;                       // Longest poll interval in us      //
+  const uint8_t  INA_SAMPLE_BUS               =      1;                       // Sampler reads bus voltage        //
+  const uint8_t  INA_SAMPLE_SHUNT             =      2;                       // Sampler reads shunt voltage      //
+  const uint8_t  INA_SAMPLE_CURRENT           =      4;                       // Sampler reads current            //
+  const uint8_t  INA_SAMPLE_POWER             =      8;                       // Sampler reads power              //
+  const uint8_t  INA_FRAME_SYNC               =   0xA5;                       // First byte of every frame        //
+  const uint8_t  INA_FRAME_HEADER             =   0x10;                       // Frame types, ORed with the       //
+  const uint8_t  INA_FRAME_KEY                =   0x20;                       // device number                    //
+  const uint8_t  INA_FRAME_DELTA              =   0x30;                       //                                  //
+  const uint8_t  INA_FRAME_HEADER_SIZE        =     16;                       // Frame sizes in bytes             //
+  const uint8_t  INA_FRAME_KEY_SIZE           =     16;                       //                                  //
+  const uint8_t  INA_FRAME_DELTA_SIZE         =     10;                       //                                  //
+  const uint8_t  INA_FRAME_MAX_SIZE           =     16;                       //                                  //
+  const uint8_t  INA_FRAME_KEY_INTERVAL       =     32;                       // Key frame at least every n       //
+  const uint8_t  INA_WINDOW_TUMBLING          =      0;                       // Consecutive separate windows     //
+  const uint8_t  INA_WINDOW_SLIDING           =      1;                       // Window moves by every sample     //
+  const uint8_t  INA_STATISTICS_CHANNELS      =      3;                       // Bus, shunt and current           //
+  const uint32_t INA_I2C_STANDARD             = 100000;                       // Standard-mode, 100kHz            //
+  const uint32_t INA_I2C_FAST                 = 400000;                       // Fast-mode, 400kHz                //
+  const uint32_t INA_I2C_FAST_PLUS            =1000000;                       // Fast-mode Plus, 1MHz             //
+  const uint32_t INA_I2C_HIGH_SPEED           =2940000;                       // High-speed mode, INA226 maximum  //
+  const uint8_t  INA_HS_MASTER_CODE           =   0x04;                       // Sent as address byte 0x08        //
+  /*****************************************************************************************************************
+  ** Declare the I2C transport interface. All bus traffic of an INA226_Class instance goes through one, so        **
+  ** another bus, a different I2C driver or a test double can be used by passing it to the constructor. write()   **
+  ** sends "size" bytes, none for an address probe, and returns the status code of Wire.endTransmission();        **
+  ** without "sendStop" the bus is held for a repeated start. read() returns the number of bytes actually         **
+  ** received.                                                                                                    **
+  *****************************************************************************************************************/
+  class INA226_Transport {                                                    // Transport interface              //
+    public:                                                                   // Publicly visible methods         //
+      virtual ~INA226_Transport() {}                                          // Virtual destructor               //
+      virtual void    begin() = 0;                                            // Prepare the bus                  //
+      virtual uint8_t write(const uint8_t deviceAddress, const uint8_t *data, // Write bytes to a device          //
+                            const uint8_t size, const bool sendStop) = 0;     //                                  //
+      virtual uint8_t read(const uint8_t deviceAddress, uint8_t *data,        // Read bytes from a device         //
+                           const uint8_t size) = 0;                           //                                  //
+  }; // of INA226_Transport definition                                        //                                  //
+  /*****************************************************************************************************************
+  ** Declare the transport for a TwoWire instance, Wire by default or e.g. Wire1 on boards with a second I2C      **
+  ** port. Devices can be split across buses with one INA226_Class instance per bus. Unless "beginWire" is false  **
+  ** the bus is started on the first use, otherwise the sketch has to call begin() of the TwoWire itself, e.g. to **
+  ** select the pins. setClock() sets standard, fast or fast-mode plus speed. setHighSpeed() selects HS-mode:     **
+  ** each transaction then starts with the HS master code at 400kHz, which no device acknowledges, and continues  **
+  ** after a repeated start at the high speed clock until the stop condition. This needs a TwoWire which supports **
+  ** clocks above 1MHz and keeps the bus after a NACK when asked to, so it isn't available on every board.        **
+  *****************************************************************************************************************/
+  class INA226_WireTransport : public INA226_Transport {                      // TwoWire transport definition     //
+    public:                                                                   // Publicly visible methods         //
+      INA226_WireTransport(TwoWire &wire=Wire, const bool beginWire=true);    // Class constructor                //
+      void    begin();                                                        // Start the bus if needed          //
+      void    setClock(const uint32_t clockHz);                               // Standard, fast or FM+ clock      //
+      void    setHighSpeed(const uint32_t clockHz=INA_I2C_HIGH_SPEED);        // HS-mode clock, 0 to leave it     //
+      uint8_t write(const uint8_t deviceAddress, const uint8_t *data,         // Write bytes to a device          //
+                    const uint8_t size, const bool sendStop);                 //                                  //
+      uint8_t read(const uint8_t deviceAddress, uint8_t *data,                // Read bytes from a device         //
+                   const uint8_t size);                                       //                                  //
+    private:                                                                  // Private variables and methods    //
+      void     enterHighSpeed();                                              // Send the HS master code          //
+      TwoWire &_Wire;                                                         // Bus used                         //
+      bool     _BeginWire;                                                    // Library calls _Wire.begin()      //
+      bool     _Started         = false;                                      // begin() has been called          //
+      bool     _HighSpeedActive = false;                                      // In HS-mode until the next stop   //
+      uint32_t _ClockHz         = 0;                                          // Clock, 0 to leave it unchanged   //
+      uint32_t _HighSpeedHz     = 0;                                          // HS-mode clock, 0 when not used   //
+  }; // of INA226_WireTransport definition                                    //                                  //
   /*****************************************************************************************************************
   ** Declare class header                                                                                         **
   *****************************************************************************************************************/
   class INA226_Class {                                                        // Class definition                 //
     public:                                                                   // Publicly visible methods         //
       INA226_Class();                                                         // Class constructor                //
+      INA226_Class(INA226_Transport &transport);                              // Constructor for another bus      //
       ~INA226_Class();                                                        // Class destructor                 //
       uint8_t  begin(const uint8_t  maxBusAmps,                               // Class initializer                //
                      const uint32_t microOhmR,                                //                                  //
                      const uint8_t  deviceNumber = UINT8_MAX );               //                                  //
+      uint8_t  fastBegin(const uint8_t  maxBusAmps,                           // Initialize from the EEPROM       //
+                         const uint32_t microOhmR,                            // record, scan only if needed      //
+                         const uint16_t eepromAddress=0);                     //                                  //
       uint16_t getBusMilliVolts(const bool waitSwitch=false,                  // Retrieve Bus voltage in mV       //
                                 const uint8_t deviceNumber=0);                //                                  //
       int16_t  getShuntMicroVolts(const bool waitSwitch=false,                // Retrieve Shunt voltage in uV     //
                                   const uint8_t deviceNumber=0);              //                                  //
       int32_t  getBusMicroAmps(const uint8_t deviceNumber=0);                 // Retrieve micro-amps              //
       int32_t  getBusMicroWatts(const uint8_t deviceNumber=0);                // Retrieve micro-watts             //
+      void     readSnapshot(const uint8_t deviceNumber,                       // Read all results in one burst    //
+                            inaSnapshot &snapshot);                           //                                  //
       void     reset(const uint8_t deviceNumber=0);                           // Reset the device                 //
       void     setMode(const uint8_t mode,const uint8_t devNumber=UINT8_MAX); // Set the monitoring mode          //
       uint8_t  getMode(const uint8_t devNumber=UINT8_MAX);                    // Get the monitoring mode          //
@@ -118,17 +350,344 @@
                                 const uint8_t deviceNumber=UINT8_MAX);        //                                  //
       void     setShuntConversion(uint8_t convTime,                           // Set timing for Shunt conversions //
                                   const uint8_t deviceNumber=UINT8_MAX);      //                                  //
-      void     waitForConversion(const uint8_t deviceNumber=UINT8_MAX);       // wait for conversion to complete  //
+      bool     waitForConversion(const uint8_t deviceNumber=UINT8_MAX);       // wait for conversion to complete  //
+      void     startConversion(const uint8_t deviceNumber=0);                 // Start waiting for a conversion   //
+      uint8_t  pollConversion(const uint8_t deviceNumber=0);                  // Check state without blocking     //
+      uint32_t getConversionMicros(const uint8_t deviceNumber=0);             // Expected conversion duration     //
+      void     setConversionCallback(inaCallback callback);                   // Set function called when ready   //
       void     setAlertPinOnConversion(const bool alertState,                 // Enable pin change on conversion  //
                                        const uint8_t deviceNumber=UINT8_MAX); //                                  //
-    private:                                                                  // Private variables and methods    //
+      void     setAlertLimit(const uint16_t alertFunction,                    // Arm a limit function with the    //
+                             const int32_t  limit,                            // limit in mA, mV or mW            //
+                             const uint8_t  deviceNumber=UINT8_MAX);          //                                  //
+      void     setAlertLatch(const bool latched,                              // Keep ALERT active until read     //
+                             const uint8_t deviceNumber=UINT8_MAX);           //                                  //
+      uint16_t getAlertFlags(const uint8_t deviceNumber=0);                   // Read and clear tripped alerts    //
+      void     beginConfig();                                                 // Collect setter changes           //
+      uint8_t  commit();                                                      // Write collected changes          //
+      uint8_t  saveDevices(const uint16_t eepromAddress=0);                   // Write topology record to EEPROM  //
+      uint8_t  restoreDevices(const uint16_t eepromAddress=0);                // Load and verify topology record  //
+      uint8_t  getTransmissionStatus();                                       // Status of the last I2C transfer  //
+      static uint16_t busToMilliVolts(const uint16_t busRaw);                 // Convert bus voltage register     //
+      static int32_t  shuntToMicroVolts(const int16_t shuntRaw);              // Convert shunt voltage register   //
+      static int32_t  currentToMicroAmps(const int16_t currentRaw,            // Convert current register         //
+                                         const inaDet &ina);                  //                                  //
+      static int32_t  powerToMicroWatts(const uint16_t powerRaw,              // Convert power register           //
+                                        const inaDet &ina);                   //                                  //
+      #ifdef INA_INSTRUMENTATION                                              // Only when instrumented           //
+        void   getBusCounters(const uint8_t deviceNumber,                     // I2C traffic of a device          //
+                              inaBusCounters &counters);                      //                                  //
+        void   getRegisterCounters(const uint8_t registerAddress,             // I2C traffic of a register        //
+                                   inaBusCounters &counters);                 //                                  //
+        void   getHistogram(const uint8_t api, inaHistogram &histogram);      // Durations of an API group        //
+        void   resetInstrumentation();                                        // Clear counters and histograms    //
+      #endif                                                                  // of if-then instrumentation       //
+    protected:                                                                // Visible to INA226_Fixed          //
+      friend class INA226_Sampler;                                            // Sampler reads registers directly //
+      friend class INA226_Accumulator;                                        // Accumulator does so as well      //
+      friend class INA226_Scheduler;                                          // and so does the scheduler        //
+      friend class INA226_Statistics;                                         // and the statistics               //
+      friend class INA226_Telemetry;                                          // and the telemetry encoder        //
+      friend class INA226_DutyCycle;                                          // and the duty cycle sampler       //
+      uint8_t  restoreDevices(const uint16_t eepromAddress,                   // Load record with new calibration //
+                              const inaDet *calibrated);                      //                                  //
+      uint8_t  beginDevices(const inaDet &calibrated,                         // Scan and write calibration       //
+                            const uint8_t deviceNumber);                      //                                  //
+      bool     readResults(const inaDet &ina, inaRawSample &raw,              // Read all result registers        //
+                           const bool onlyIfReady=false);                     //                                  //
+      void     computeCalibration(const uint8_t maxBusAmps,                   // Calibration and LSBs for the     //
+                                  const uint32_t microOhmR, inaDet &ina);     // current and shunt given          //
+      uint16_t alertLimitRaw(const uint16_t alertFunction,                    // Convert a limit to the register  //
+                             const int32_t limit, const inaDet &ina);         //                                  //
+      static uint8_t crc8(uint8_t crc, const uint8_t data);                   // Add a byte to a CRC-8            //
+      uint8_t  topologyChecksum(const uint16_t eepromAddress,                 // CRC-8 of the EEPROM record       //
+                                const uint8_t deviceCount);                   //                                  //
+      void     updateConfig(const uint8_t device, const uint16_t clearBits,   // Change the shadow configuration  //
+                            const uint16_t setBits);                          // and write or defer it            //
+      void     updateMask(const uint8_t device, const uint16_t clearBits,     // Change the shadow mask/enable    //
+                          const uint16_t setBits);                            // and write or defer it            //
+      void     setPointer(const uint8_t addr, const uint8_t deviceAddress,    // Write register pointer if needed //
+                          const bool repeatedStart=false);                    //                                  //
       uint8_t  readByte(const uint8_t addr, const uint8_t deviceAddress);     // Read a byte from an I2C address  //
-      int16_t  readWord(const uint8_t addr, const uint8_t deviceAddress);     // Read a word from an I2C address  //
+      int16_t  readWord(const uint8_t addr, const uint8_t deviceAddress,      // Read a word from an I2C address  //
+                        const bool repeatedStart=false);                      //                                  //
+      uint16_t readMask(const inaDet &ina, const bool repeatedStart=false);   // Read mask/enable, keep the flags //
+      uint32_t conversionMicros(const uint16_t configRegister);               // Duration from configuration      //
       void     writeByte(const uint8_t addr, const uint8_t data,              // Write a byte to an I2C address   //
                          const uint8_t deviceAddress);                        //                                  //
       void     writeWord(const uint8_t addr, const uint16_t data,             // Write two bytes to an I2C address//
                          const uint8_t deviceAddress);                        //                                  //
+      #ifdef INA_INSTRUMENTATION                                              // Only when instrumented           //
+        void   countTransfer(const uint8_t deviceAddress, const uint8_t addr, // Count one I2C transaction        //
+                             const uint8_t bytes, const uint8_t status,       //                                  //
+                             const bool hold);                                //                                  //
+        inaBusCounters _DeviceCounters[16];                                   // Per address 0x40 to 0x4F         //
+        inaBusCounters _RegisterCounters[INA_REGISTER_SLOTS];                 // Per register                     //
+        inaHistogram   _Histograms[INA_API_COUNT];                            // Per API group                    //
+        bool           _BusHeld = false;                                      // Last transfer ended w/o a STOP   //
+      #endif                                                                  // of if-then instrumentation       //
+      INA226_Transport *_Transport;                                           // Bus all transfers go through     //
       uint8_t  _TransmissionStatus = 0;                                       // Return code for I2C transmission //
       uint8_t  _DeviceCount        = 0;                                       // Number of INA226s detected       //
+      inaDet   _Devices[INA_MAX_DEVICES];                                     // RAM-resident device table        //
+      uint8_t  _RegisterPointer[16];                                          // Last pointer for 0x40 to 0x4F    //
+      inaConversion _Conversions[INA_MAX_DEVICES];                            // Started conversion per device    //
+      inaCallback   _ConversionCallback = NULL;                               // Called when conversion is ready  //
+      bool     _ConfigBatch        = false;                                   // Between beginConfig()/commit()   //
+      uint16_t _ConfigPending      = 0;                                       // Devices with unwritten config    //
+      uint16_t _MaskPending        = 0;                                       // and mask/enable, bit per device  //
+      static_assert(INA_MAX_DEVICES<=16,                                      // The pending masks hold one bit   //
+                    "INA_MAX_DEVICES can't be more than 16");                 // per device                       //
+      volatile uint16_t _AlertPending[INA_MAX_DEVICES] = {};                  // Flags read, for getAlertFlags()  //
   }; // of INA226_Class definition                                            //                                  //
+  /*****************************************************************************************************************
+  ** Declare the compile-time calibrated class. When the maximum current and the shunt resistance are known when  **
+  ** the program is built, the calibration register and the LSBs are computed by the compiler and the current and **
+  ** power conversions become a 32-bit multiply and shift instead of the 64-bit multiply and divide used by the   **
+  ** INA226_Class getters. The multipliers are the largest which still fit into 16 bits, so the products can't    **
+  ** overflow and the results differ from those of INA226_Class by rounding only, less than 0.03% of full scale.  **
+  **                                                                                                              **
+  **   INA226_Fixed<1,100000> INA226;         // +-1A maximum through a 0.1 Ohm shunt                             **
+  **   INA226.begin();                        // Scan and write the calibration to all devices                    **
+  *****************************************************************************************************************/
+  template <uint8_t MaxAmps, uint32_t ShuntMicroOhm>                          // Maximum current and shunt value  //
+  class INA226_Fixed : public INA226_Class {                                  // Class definition                 //
+    public:                                                                   // Publicly visible methods         //
+      using INA226_Class::INA226_Class;                                       // Same constructors                //
+      static constexpr uint32_t CURRENT_LSB = (uint64_t)MaxAmps*1000000000/32767;// LSB in nA                     //
+      static constexpr uint32_t POWER_LSB   = (uint32_t)25*CURRENT_LSB;       // Fixed multiplier for INA226      //
+      static constexpr uint32_t CALIBRATION = (uint64_t)51200000/             // Calibration register value       //
+        ((uint64_t)CURRENT_LSB*ShuntMicroOhm/100000);                         //                                  //
+      uint8_t begin(const uint8_t deviceNumber=UINT8_MAX) {                   // Scan and calibrate               //
+        inaDet calibrated      = {};                                          // Precomputed device values, the   //
+        calibrated.calibration = CALIBRATION;                                 // remaining fields are set by      //
+        calibrated.current_LSB = CURRENT_LSB;                                 // beginDevices()                   //
+        calibrated.power_LSB   = POWER_LSB;                                   //                                  //
+        return beginDevices(calibrated,deviceNumber);                         //                                  //
+      } // of method begin()                                                  //                                  //
+      int32_t getBusMicroAmps(const uint8_t deviceNumber=0) {                 // Retrieve micro-amps              //
+        return currentToMicroAmps(readWord(INA_CURRENT_REGISTER,              //                                  //
+                                  _Devices[deviceNumber%_DeviceCount].address));//                                //
+      } // of method getBusMicroAmps()                                        //                                  //
+      int32_t getBusMicroWatts(const uint8_t deviceNumber=0) {                // Retrieve micro-watts             //
+        return powerToMicroWatts(readWord(INA_POWER_REGISTER,                 //                                  //
+                                 _Devices[deviceNumber%_DeviceCount].address));//                                 //
+      } // of method getBusMicroWatts()                                       //                                  //
+      void readSnapshot(const uint8_t deviceNumber, inaSnapshot &snapshot) {  // Read all results in one burst    //
+        inaRawSample raw;                                                     // Raw register values              //
+        snapshot.conversionReady = readResults(                               // Read all result registers        //
+                                     _Devices[deviceNumber%_DeviceCount],raw);//                                  //
+        snapshot.timestamp       = raw.timestamp;                             //                                  //
+        snapshot.busMilliVolts   = busToMilliVolts(raw.bus);                  // Convert to engineering units     //
+        snapshot.shuntMicroVolts = shuntToMicroVolts(raw.shunt);              //                                  //
+        snapshot.busMicroAmps    = currentToMicroAmps(raw.current);           //                                  //
+        snapshot.busMicroWatts   = powerToMicroWatts(raw.power);              //                                  //
+      } // of method readSnapshot()                                           //                                  //
+      static int32_t currentToMicroAmps(const int16_t currentRaw) {           // Convert current register         //
+        return ((int32_t)currentRaw*CURRENT_MULTIPLIER)>>CURRENT_SHIFT;       //                                  //
+      } // of method currentToMicroAmps()                                     //                                  //
+      static int32_t powerToMicroWatts(const uint16_t powerRaw) {             // Convert power register           //
+        return ((uint32_t)powerRaw*POWER_MULTIPLIER)>>POWER_SHIFT;            //                                  //
+      } // of method powerToMicroWatts()                                      //                                  //
+    private:                                                                  // Private variables and methods    //
+      static constexpr uint8_t shiftFor(const uint64_t numerator,             // Largest shift which keeps the    //
+                                        const uint32_t denominator,           // multiplier below 2^16            //
+                                        const uint8_t shift=31) {             //                                  //
+        return (shift==0 || ((numerator<<shift)+denominator/2)/denominator    //                                  //
+                <65536) ? shift : shiftFor(numerator,denominator,shift-1);    //                                  //
+      } // of method shiftFor()                                               //                                  //
+      static constexpr uint8_t  CURRENT_SHIFT      = shiftFor(CURRENT_LSB,1000);// uA = raw*LSB/1000              //
+      static constexpr int32_t  CURRENT_MULTIPLIER = (((uint64_t)CURRENT_LSB  //                                  //
+        <<CURRENT_SHIFT)+500)/1000;                                           //                                  //
+      static constexpr uint8_t  POWER_SHIFT        = shiftFor(POWER_LSB,1000);// uW = raw*LSB/1000                //
+      static constexpr uint32_t POWER_MULTIPLIER   = (((uint64_t)POWER_LSB    //                                  //
+        <<POWER_SHIFT)+500)/1000;                                             //                                  //
+      static_assert(MaxAmps>0 && CALIBRATION>0 && CALIBRATION<32768,          // Check the parameters at          //
+                    "INA226_Fixed calibration out of range");                 // compile time                     //
+      static_assert(CURRENT_MULTIPLIER<65536 && POWER_MULTIPLIER<65536,       //                                  //
+                    "INA226_Fixed MaxAmps too large for 32-bit conversion");  //                                  //
+  }; // of INA226_Fixed definition                                            //                                  //
+  /*****************************************************************************************************************
+  ** Declare the sampling engine class. sampleISR() is called from the interrupt handler of the ALERT pin and     **
+  ** puts the raw registers into a single-producer/single-consumer ring buffer, read() is called from loop() to   **
+  ** take them out again and convert them. Neither side needs to disable interrupts.                              **
+  *****************************************************************************************************************/
+  class INA226_Sampler {                                                      // Sampling engine definition       //
+    public:                                                                   // Publicly visible methods         //
+      INA226_Sampler(INA226_Class &ina);                                      // Class constructor                //
+      void     begin(const uint8_t sampleFields=INA_SAMPLE_BUS|               // Set registers to be sampled and  //
+                                                INA_SAMPLE_CURRENT,           // enable the conversion alert      //
+                     const uint8_t deviceNumber=UINT8_MAX);                   //                                  //
+      void     sampleISR(const uint8_t deviceNumber=0);                       // Capture sample, called from ISR  //
+      uint8_t  available();                                                   // Number of samples in buffer      //
+      uint8_t  read(inaSample *samples, const uint8_t maxSamples);            // Take and convert samples         //
+      uint32_t getOverflows();                                                // Samples lost as buffer was full  //
+    private:                                                                  // Private variables and methods    //
+      int16_t  readField(const uint8_t field, const uint8_t addr,             // Read register if it is selected  //
+                         const uint8_t deviceAddress);                        //                                  //
+      INA226_Class     &_INA;                                                 // Device class used for reading    //
+      uint8_t           _SampleFields = 0;                                    // Registers read in sampleISR()    //
+      volatile uint8_t  _Head         = 0;                                    // Only written by sampleISR()      //
+      volatile uint8_t  _Tail         = 0;                                    // Only written by read()           //
+      volatile uint32_t _Overflows    = 0;                                    // Only written by sampleISR()      //
+      volatile inaRawSample _Buffer[INA_SAMPLE_BUFFER_SIZE];                  // Ring buffer of samples           //
+  }; // of INA226_Sampler definition                                          //                                  //
+  /*****************************************************************************************************************
+  ** Declare the charge and energy accumulator class. One instance integrates the current and power registers of  **
+  ** one device, each conversion counting for the conversion period computed from the device's averaging and      **
+  ** conversion time settings, so the totals don't depend on when the readings are taken. add() and accumulate()  **
+  ** only add 32-bit values and are meant to be called from the ALERT pin interrupt handler, read() and reset()   **
+  ** are called from loop() while sampling continues.                                                             **
+  *****************************************************************************************************************/
+  class INA226_Accumulator {                                                  // Accumulator definition           //
+    public:                                                                   // Publicly visible methods         //
+      INA226_Accumulator(INA226_Class &ina, const uint8_t deviceNumber=0);    // Class constructor                //
+      bool     accumulate();                                                  // Add conversion if it is ready    //
+      void     add(const int16_t currentRaw, const uint16_t powerRaw);        // Add one conversion               //
+      void     read(inaEnergy &energy, const bool resetTotals=false);         // Read and optionally reset        //
+      void     reset();                                                       // Clear the totals                 //
+    private:                                                                  // Private variables and methods    //
+      void     fold();                                                        // Move sums into the totals        //
+      INA226_Class &_INA;                                                     // Device class used for reading    //
+      uint8_t   _DeviceNumber;                                                // Device integrated                //
+      uint16_t  _Configuration    = 0;                                        // Settings the sums were taken at  //
+      int32_t   _CurrentSum       = 0;                                        // Current registers since fold()   //
+      int32_t   _PowerSum         = 0;                                        // Power registers, signed          //
+      uint16_t  _Conversions      = 0;                                        // Conversions since fold()         //
+      int64_t   _ChargeRaw        = 0;                                        // Current LSBs times us            //
+      int64_t   _EnergyRaw        = 0;                                        // Power LSBs times us              //
+      uint64_t  _Micros           = 0;                                        // Integrated time in us            //
+      uint32_t  _TotalConversions = 0;                                        // Conversions integrated           //
+  }; // of INA226_Accumulator definition                                      //                                  //
+  /*****************************************************************************************************************
+  ** Declare the multi-device scheduler class. It keeps a deadline for each device at which its next conversion   **
+  ** is due, computed from the device's averaging and conversion time settings, and each call to tick() reads     **
+  ** only the devices which are due, so a heavily averaged device doesn't hold up the fast ones. Devices are      **
+  ** serviced round-robin and the samples of one tick are returned together.                                      **
+  *****************************************************************************************************************/
+  class INA226_Scheduler {                                                    // Scheduler definition             //
+    public:                                                                   // Publicly visible methods         //
+      INA226_Scheduler(INA226_Class &ina);                                    // Class constructor                //
+      void     begin();                                                       // Start scheduling all devices     //
+      uint8_t  tick(inaSample *samples, const uint8_t maxSamples);            // Read all devices which are due   //
+      uint32_t getMicrosToNext();                                             // Time until next device is due    //
+      void     getStats(const uint8_t deviceNumber, inaScheduleStats &stats); // Rate and slip of a device        //
+      void     resetStats();                                                  // Clear the statistics             //
+    private:                                                                  // Private variables and methods    //
+      INA226_Class &_INA;                                                     // Device class used for reading    //
+      uint8_t       _Next = 0;                                                // Device to look at first          //
+      inaSchedule   _Schedules[INA_MAX_DEVICES];                              // Deadline and stats per device    //
+  }; // of INA226_Scheduler definition                                        //                                  //
+  /*****************************************************************************************************************
+  ** Declare the streaming statistics class. It keeps the minimum, maximum, mean, variance and RMS of the bus     **
+  ** voltage, shunt voltage and current of one device over a window of samples, using integer arithmetic only.    **
+  ** Tumbling windows are summarized once when full and restarted, sliding windows always cover the latest        **
+  ** samples. Samples can be decimated in software by averaging several conversions into one first.               **
+  *****************************************************************************************************************/
+  class INA226_Statistics {                                                   // Statistics definition            //
+    public:                                                                   // Publicly visible methods         //
+      INA226_Statistics(INA226_Class &ina, const uint8_t deviceNumber=0);     // Class constructor                //
+      void     setWindow(const uint16_t windowSamples,                        // Window length and type and the   //
+                         const uint8_t  windowType=INA_WINDOW_TUMBLING,       // number of conversions averaged   //
+                         const uint8_t  decimation=1);                        // into each sample                 //
+      bool     sample();                                                      // Add conversion if it is ready    //
+      bool     add(const inaRawSample &raw);                                  // Add one conversion               //
+      bool     read(inaStatistics &stats);                                    // Statistics of the latest window  //
+      void     reset();                                                       // Start an empty window            //
+    private:                                                                  // Private variables and methods    //
+      void     insert(const int32_t *values);                                 // Add a sample to the window       //
+      void     remove(const int32_t *values);                                 // Take a sample out of the window  //
+      void     recompute();                                                   // Exact values from the buffer     //
+      void     summarize(const inaWelford &welford, const uint8_t channel,    // Convert a channel to             //
+                         const uint16_t count, inaChannelStats &stats);       // engineering units                //
+      INA226_Class &_INA;                                                     // Device class used for reading    //
+      uint8_t       _DeviceNumber;                                            // Device analyzed                  //
+      uint16_t      _WindowSamples = 1;                                       // Samples per window               //
+      uint8_t       _WindowType    = INA_WINDOW_TUMBLING;                     // Tumbling or sliding              //
+      uint8_t       _Decimation    = 1;                                       // Conversions per sample           //
+      uint8_t       _Decimated     = 0;                                       // Conversions in _DecimationSum    //
+      int32_t       _DecimationSum[INA_STATISTICS_CHANNELS];                  // Sum of the conversions           //
+      uint16_t      _Count         = 0;                                       // Samples in the running window    //
+      uint32_t      _Timestamp     = 0;                                       // Time of the latest sample        //
+      inaWelford    _Running[INA_STATISTICS_CHANNELS];                        // Window being filled              //
+      inaWelford    _Completed[INA_STATISTICS_CHANNELS];                      // Last full tumbling window        //
+      uint16_t      _CompletedCount = 0;                                      // Samples in _Completed            //
+      uint32_t      _CompletedTime  = 0;                                      // Time of its last sample          //
+      bool          _Unread         = false;                                  // New results since read()         //
+      uint16_t      _Oldest         = 0;                                      // Oldest entry in _Window          //
+      int16_t       _Window[INA_STATISTICS_WINDOW_SIZE][INA_STATISTICS_CHANNELS];// Samples of a sliding window   //
+  }; // of INA226_Statistics definition                                       //                                  //
+  /*****************************************************************************************************************
+  ** Declare the telemetry class. It sends the raw result registers as compact binary frames to a Print object,   **
+  ** usually Serial, instead of formatted text. All values are little-endian and every frame starts with the sync **
+  ** byte INA_FRAME_SYNC, followed by the frame type ORed with the device number, and ends with a CRC-8           **
+  ** (polynomial 0x07) of all bytes before it:                                                                    **
+  **                                                                                                              **
+  **   Header frame, 16 bytes: I2C address, configuration (2), calibration (2), current LSB in nA (4) and         **
+  **                           power LSB in nW (4). Sent by begin() for every device.                             **
+  **   Key frame,    16 bytes: sequence number, micros() timestamp (4), bus, shunt, current and power registers   **
+  **                           (2 each)                                                                           **
+  **   Delta frame,  10 bytes: sequence number, microseconds since the device's last frame (2) and the changes    **
+  **                           of the four registers (1 each)                                                     **
+  **                                                                                                              **
+  ** A delta frame is sent when all changes fit, otherwise and at least every INA_FRAME_KEY_INTERVAL frames a key **
+  ** frame. The decoder in extras/host rebuilds engineering units from the header frames and uses the sequence    **
+  ** numbers to skip delta frames after a lost frame until the next key frame.                                    **
+  *****************************************************************************************************************/
+  class INA226_Telemetry {                                                    // Telemetry definition             //
+    public:                                                                   // Publicly visible methods         //
+      INA226_Telemetry(INA226_Class &ina, Print &output);                     // Class constructor                //
+      void     begin();                                                       // Send the header frames           //
+      bool     sample(const uint8_t deviceNumber=0);                          // Send conversion if it is ready   //
+      uint8_t  encode(const inaRawSample &raw, uint8_t *frame);               // Encode a sample frame            //
+      uint8_t  encodeHeader(const uint8_t deviceNumber, uint8_t *frame);      // Encode a header frame            //
+    private:                                                                  // Private variables and methods    //
+      static uint8_t seal(uint8_t *frame, const uint8_t size);                // Append the CRC                   //
+      INA226_Class &_INA;                                                     // Device class used for reading    //
+      Print        &_Output;                                                  // Where frames are written to      //
+      inaRawSample  _Last[INA_MAX_DEVICES];                                   // Last sample sent per device      //
+      uint8_t       _Sequence[INA_MAX_DEVICES];                               // Frame counter per device         //
+      uint8_t       _SinceKey[INA_MAX_DEVICES];                               // Frames since the last key frame  //
+      static_assert(INA_MAX_DEVICES<=16,                                      // Frame types carry the device     //
+                    "INA_MAX_DEVICES can't be more than 16");                 // number in their low nibble       //
+  }; // of INA226_Telemetry definition                                        //                                  //
+  /*****************************************************************************************************************
+  ** Declare the duty cycle class for battery powered nodes. One device rests in power-down mode and tick() wakes **
+  ** it every "periodMicros" with a single write of a triggered mode to the configuration register, which starts  **
+  ** one conversion. Once it has finished the four result registers are read and the device is powered down again **
+  ** with a second write, which also releases the ALERT pin. When the ALERT pin is wired to an interrupt whose    **
+  ** handler calls alertISR() a cycle takes these 6 transactions, when polling one more for each look at the      **
+  ** conversion ready flag. Between the calls the sketch can sleep for getMicrosToNext(). getStats() returns the  **
+  ** estimated duty cycle of the sensor, its conversion time over the period, besides counters.                   **
+  *****************************************************************************************************************/
+  class INA226_DutyCycle {                                                    // Duty cycle definition            //
+    public:                                                                   // Publicly visible methods         //
+      INA226_DutyCycle(INA226_Class &ina, const uint8_t deviceNumber=0);      // Class constructor                //
+      void     begin(const uint32_t periodMicros,                             // Period, mode triggered, whether  //
+                     const uint8_t  mode=INA_MODE_TRIGGERED_BOTH,             // the ALERT pin is used and if the //
+                     const bool     alertPin=false,                           // device is powered down between   //
+                     const bool     powerDown=true);                          // conversions                      //
+      void     end();                                                         // Back to the previous mode        //
+      bool     tick(inaSnapshot &snapshot);                                   // Trigger or read when due         //
+      uint32_t getMicrosToNext();                                             // Time the sketch can sleep        //
+      void     alertISR();                                                    // Call from the ALERT interrupt    //
+      void     getStats(inaDutyStats &stats);                                 // Counters and duty cycle          //
+    private:                                                                  // Private variables and methods    //
+      void     finish(const uint32_t now);                                    // Power down, schedule next        //
+      INA226_Class &_INA;                                                     // Device class used for reading    //
+      uint8_t       _DeviceNumber;                                            // Device sampled                   //
+      uint8_t       _Mode          = INA_MODE_TRIGGERED_BOTH;                 // Triggered mode written           //
+      uint8_t       _SavedMode     = INA_MODE_CONTINUOUS_BOTH;                // Mode before begin()              //
+      bool          _AlertPin      = false;                                   // Wait for alertISR()              //
+      bool          _PowerDown     = true;                                    // Power down after reading         //
+      bool          _Pending       = false;                                   // Conversion triggered             //
+      volatile bool _Alerted       = false;                                   // Set by alertISR()                //
+      uint32_t      _Period        = 0;                                       // Trigger period in us             //
+      uint32_t      _Duration      = 0;                                       // Conversion time in us            //
+      uint32_t      _NextDue       = 0;                                       // micros() of next trigger         //
+      uint32_t      _Triggered     = 0;                                       // micros() of last trigger         //
+      uint32_t      _Cycles        = 0;                                       // Snapshots read                   //
+      uint32_t      _Missed        = 0;                                       // Triggers without a result        //
+      uint64_t      _LatencySum    = 0;                                       // Trigger to snapshot in us        //
+  }; // of INA226_DutyCycle definition                                        //                                  //
 #endif                                                                        //----------------------------------//
@@ -0,0 +1,95 @@
+/*******************************************************************************************************************
+** Host replacement for the Arduino core header. Only the parts of the Arduino API used by the INA226 library and **
+** its examples are provided. Time is simulated: micros() and millis() return a clock which only moves forward    **
+** when delay(), delayMicroseconds() or an I2C transfer on the simulated bus consumes time.                       **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#ifndef Arduino_h                                                             // Guard code definition            //
+  #define Arduino_h                                                           // Define the name inside guard     //
+  #include <stdint.h>                                                         // Standard integer types           //
+  #include <stddef.h>                                                         // size_t definition                //
+  #include <string.h>                                                         // strlen() and memcpy()            //
+  #include <math.h>                                                           // Floating point functions         //
+  /*****************************************************************************************************************
+  ** Declare the binary constants and bit macros used by the library                                              **
+  *****************************************************************************************************************/
+  #define B000        0                                                       // Binary constants from the        //
+  #define B001        1                                                       // Arduino binary.h header          //
+  #define B010        2                                                       //                                  //
+  #define B011        3                                                       //                                  //
+  #define B100        4                                                       //                                  //
+  #define B101        5                                                       //                                  //
+  #define B110        6                                                       //                                  //
+  #define B111        7                                                       //                                  //
+  #define B00001111  15                                                       //                                  //
+  #define bit(b)                ((uint32_t)1<<(b))                            // Value of a single bit            //
+  #define bitRead(value,b)      (((value)>>(b))&0x01)                         // Read one bit from a value        //
+  #define bitSet(value,b)       ((value)|=bit(b))                             // Set one bit in a value           //
+  #define bitClear(value,b)     ((value)&=~bit(b))                            // Clear one bit in a value         //
+  #define F(string)             (string)                                      // No flash strings on the host     //
+  #define cli()                 noInterrupts()                                // AVR style interrupt control      //
+  #define sei()                 interrupts()                                  //                                  //
+  #define DEC 10                                                              // Number bases used by print()     //
+  #define HEX 16                                                              //                                  //
+  /*****************************************************************************************************************
+  ** Declare the timing and interrupt functions                                                                   **
+  *****************************************************************************************************************/
+  uint32_t millis();                                                          // Simulated milliseconds           //
+  uint32_t micros();                                                          // Simulated microseconds           //
+  void     delay(const uint32_t ms);                                          // Advance simulated time in ms     //
+  void     delayMicroseconds(const uint32_t us);                              // Advance simulated time in us     //
+  void     noInterrupts();                                                    // Clear the simulated I flag       //
+  void     interrupts();                                                      // Set it, take a raised interrupt  //
+  namespace ArduinoHost {                                                     // Host-only helpers                //
+    void     advanceMicros(const uint32_t us);                                // Move the simulated clock         //
+    uint64_t nowMicros();                                                     // 64-bit simulated clock           //
+    void     raiseInterrupt(void (*handler)());                               // Run handler once enabled         //
+    /***************************************************************************************************************
+    ** The simulated AVR status register. Only bit 7, the global interrupt enable flag, is used. A handler raised **
+    ** with raiseInterrupt() runs at once if the flag is set, otherwise as soon as it is set again by             **
+    ** interrupts() or by writing SREG, and runs with the flag cleared as an AVR interrupt handler does.          **
+    ***************************************************************************************************************/
+    class StatusRegister {                                                    // Simulated SREG                   //
+      public:                                                                 // Publicly visible methods         //
+        operator uint8_t() const {return _Value;}                             // Read the register                //
+        StatusRegister &operator=(const uint8_t value);                       // Write it, may take an interrupt  //
+      private:                                                                // Private variables and methods    //
+        uint8_t _Value = 0x80;                                                // Interrupts start enabled         //
+    }; // of class StatusRegister                                             //                                  //
+    extern StatusRegister statusRegister;                                     // The only instance                //
+  } // of namespace ArduinoHost                                               //                                  //
+  #define SREG ArduinoHost::statusRegister                                    // AVR status register              //
+  /*****************************************************************************************************************
+  ** Declare a minimal Print class and the Serial instance, output goes to stderr                                 **
+  *****************************************************************************************************************/
+  class Print {                                                               // Base class for text output       //
+    public:                                                                   // Publicly visible methods         //
+      virtual ~Print() {}                                                     // Virtual destructor               //
+      virtual size_t write(const uint8_t data) = 0;                           // Write a single byte              //
+      virtual size_t write(const uint8_t *buffer, size_t size);               // Write a buffer of bytes          //
+      size_t print(const char *text);                                         // Print a string                   //
+      size_t print(const char character);                                     // Print a single character         //
+      size_t print(const int value, const int base=DEC);                      // Print signed values              //
+      size_t print(const unsigned int value, const int base=DEC);             // Print unsigned values            //
+      size_t print(const long value, const int base=DEC);                     //                                  //
+      size_t print(const unsigned long value, const int base=DEC);            //                                  //
+      size_t print(const long long value, const int base=DEC);                //                                  //
+      size_t print(const unsigned long long value, const int base=DEC);       //                                  //
+      size_t print(const double value, const int digits=2);                   // Print floating point values      //
+      size_t println();                                                       // Print a line end                 //
+      template <typename T> size_t println(const T value) {                   // Print any value with line end    //
+        size_t n = print(value); return n+println();                          //                                  //
+      } // of method println()                                                //                                  //
+      template <typename T> size_t println(const T value, const int format) { // Print value in format + newline  //
+        size_t n = print(value,format); return n+println();                   //                                  //
+      } // of method println()                                                //                                  //
+  }; // of class Print                                                        //                                  //
+  class HardwareSerial : public Print {                                       // Serial port on the host          //
+    public:                                                                   // Publicly visible methods         //
+      void   begin(const uint32_t baudRate) {(void)baudRate;}                 // Nothing to initialize            //
+      size_t write(const uint8_t data);                                       // Write byte to stderr             //
+      using  Print::write;                                                    // Keep the buffer version          //
+  }; // of class HardwareSerial                                               //                                  //
+  extern HardwareSerial Serial;                                               // Global serial instance           //
+#endif                                                                        //----------------------------------//
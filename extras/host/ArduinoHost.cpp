@@ -0,0 +1,161 @@
+/*******************************************************************************************************************
+** Host implementation of the Arduino core, Wire and EEPROM replacements declared in Arduino.h, Wire.h and        **
+** EEPROM.h. See those files for a description of how the simulated clock and bus work.                           **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#include "Arduino.h"                                                          // Arduino data type definitions    //
+#include "Wire.h"                                                             // I2C Library definition           //
+#include "EEPROM.h"                                                           // EEPROM Library definition        //
+#include <stdio.h>                                                            // Standard output for Serial       //
+HardwareSerial Serial;                                                        // Global serial instance           //
+TwoWire        Wire;                                                          // Global I2C bus instance          //
+TwoWire        Wire1;                                                         // Second I2C bus instance          //
+EEPROMClass    EEPROM;                                                        // Global EEPROM instance           //
+static uint64_t simulatedMicros = 0;                                          // Simulated clock                  //
+/*******************************************************************************************************************
+** Timing and interrupt functions. The clock only moves when time is consumed explicitly                          **
+*******************************************************************************************************************/
+void     ArduinoHost::advanceMicros(const uint32_t us) {simulatedMicros+=us;} // Move the simulated clock         //
+uint64_t ArduinoHost::nowMicros() {return simulatedMicros;}                   // 64-bit simulated clock           //
+uint32_t micros() {return (uint32_t)simulatedMicros;}                         // Wraps like the real micros()     //
+uint32_t millis() {return (uint32_t)(simulatedMicros/1000);}                  // Wraps like the real millis()     //
+void     delay(const uint32_t ms) {simulatedMicros += (uint64_t)ms*1000;}     // Time passes instantly            //
+void     delayMicroseconds(const uint32_t us) {simulatedMicros += us;}        //                                  //
+void     noInterrupts() {SREG = SREG&~0x80;}                                  // Clear the I flag                 //
+void     interrupts()   {SREG = SREG|0x80;}                                   // Set it, may take an interrupt    //
+/*******************************************************************************************************************
+** Simulated interrupts. A raised handler is pending until the I flag is set, it then runs with the flag cleared  **
+** and the flag is set again afterwards, as on return from an AVR interrupt handler                               **
+*******************************************************************************************************************/
+ArduinoHost::StatusRegister ArduinoHost::statusRegister;                      // Simulated SREG                   //
+static void (*pendingHandler)() = NULL;                                       // Raised interrupt not taken yet   //
+void ArduinoHost::raiseInterrupt(void (*handler)()) {                         // Run handler once enabled         //
+  pendingHandler = handler;                                                   //                                  //
+  statusRegister = (uint8_t)statusRegister;                                   // Taken at once if enabled         //
+} // of function raiseInterrupt()                                             //                                  //
+ArduinoHost::StatusRegister &ArduinoHost::StatusRegister::operator=(const uint8_t value) {// Write the register   //
+  _Value = value;                                                             //                                  //
+  while ((_Value&0x80) && pendingHandler!=NULL) {                             // Interrupt enabled and pending    //
+    void (*handler)() = pendingHandler;                                       //                                  //
+    pendingHandler = NULL;                                                    //                                  //
+    _Value &= ~0x80;                                                          // Disabled in the handler          //
+    handler();                                                                //                                  //
+    _Value |= 0x80;                                                           // Enabled again on return          //
+  } // of while interrupt pending                                             //                                  //
+  return *this;                                                               //                                  //
+} // of method operator=()                                                    //                                  //
+/*******************************************************************************************************************
+** Print class methods, numbers are formatted with printf() which is good enough for the host                     **
+*******************************************************************************************************************/
+size_t Print::write(const uint8_t *buffer, size_t size) {                     // Write a buffer of bytes          //
+  size_t n = 0;                                                               // Bytes written                    //
+  while (size--) n += write(*buffer++);                                       // Write each byte in turn          //
+  return n;                                                                   //                                  //
+} // of method write()                                                        //                                  //
+size_t Print::print(const char *text) {                                       // Print a string                   //
+  return write((const uint8_t*)text,strlen(text));                            //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const char character) {return write((uint8_t)character);} // Print a single character         //
+size_t Print::print(const long long value, const int base) {                  // Print signed values              //
+  char buffer[24];                                                            // Big enough for 64 bits           //
+  if (base==HEX) snprintf(buffer,sizeof(buffer),"%llX",value);                //                                  //
+            else snprintf(buffer,sizeof(buffer),"%lld",value);                //                                  //
+  return print(buffer);                                                       //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const unsigned long long value, const int base) {         // Print unsigned values            //
+  char buffer[24];                                                            // Big enough for 64 bits           //
+  if (base==HEX) snprintf(buffer,sizeof(buffer),"%llX",value);                //                                  //
+            else snprintf(buffer,sizeof(buffer),"%llu",value);                //                                  //
+  return print(buffer);                                                       //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const int value, const int base) {                        // Smaller types use 64 bits        //
+  return print((long long)value,base);                                        //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const unsigned int value, const int base) {               //                                  //
+  return print((unsigned long long)value,base);                               //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const long value, const int base) {                       //                                  //
+  return print((long long)value,base);                                        //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const unsigned long value, const int base) {              //                                  //
+  return print((unsigned long long)value,base);                               //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::print(const double value, const int digits) {                   // Print floating point values      //
+  char buffer[32];                                                            //                                  //
+  snprintf(buffer,sizeof(buffer),"%.*f",digits,value);                        //                                  //
+  return print(buffer);                                                       //                                  //
+} // of method print()                                                        //                                  //
+size_t Print::println() {return print("\n");}                                 // Print a line end                 //
+size_t HardwareSerial::write(const uint8_t data) {                            // Write byte to stderr, keeping    //
+  return fputc(data,stderr)==EOF ? 0 : 1;                                     // stdout for program results       //
+} // of method write()                                                        //                                  //
+/*******************************************************************************************************************
+** TwoWire class methods                                                                                          **
+*******************************************************************************************************************/
+void TwoWire::begin() {_Begins++;}                                            // Count begin() calls              //
+void TwoWire::setClock(const uint32_t clockHz) {_ClockHz = clockHz;}          // Set the bus clock speed          //
+void TwoWire::attach(I2CDevice &device) {                                     // Add simulated device to bus      //
+  if (_DeviceCount<WIRE_MAX_DEVICES) _Devices[_DeviceCount++] = &device;      //                                  //
+} // of method attach()                                                       //                                  //
+void TwoWire::detachAll() {_DeviceCount = 0;}                                 // Remove all devices from bus      //
+I2CDevice *TwoWire::find(const uint8_t address) {                             // Find attached device             //
+  for(uint8_t i=0;i<_DeviceCount;i++) {                                       // Loop for each device             //
+    if (_Devices[i]->address()==address && _Devices[i]->present())            // Return device if it answers      //
+      return _Devices[i];                                                     //                                  //
+  } // for-next each device                                                   //                                  //
+  return NULL;                                                                // Nobody acknowledges address      //
+} // of method find()                                                         //                                  //
+/*******************************************************************************************************************
+** Method busTime advances the simulated clock by the duration of a transfer: a start condition, 9 clocks for     **
+** the address byte and each data byte and, unless the bus is held for a repeated start, a stop condition.        **
+*******************************************************************************************************************/
+void TwoWire::busTime(const uint8_t bytes, const bool stop) {                 // Advance clock for transfer       //
+  uint32_t bits   = 1+9*(1+(uint32_t)bytes)+(stop?1:0);                       // Start, bytes, stop               //
+  uint32_t us     = (bits*1000000+_ClockHz-1)/_ClockHz;                       // Round up to whole us             //
+  stats.bytes    += 1+bytes;                                                  // Count address byte too           //
+  stats.busMicros+= us;                                                       //                                  //
+  if (!_Repeated) stats.transactions++;                                       // Repeated start continues         //
+  _Repeated       = !stop;                                                    // transaction until a stop         //
+  ArduinoHost::advanceMicros(us);                                             //                                  //
+} // of method busTime()                                                      //                                  //
+void TwoWire::beginTransmission(const uint8_t address) {                      // Start a write to a device        //
+  _TxAddress = address;                                                       //                                  //
+  _TxLength  = 0;                                                             //                                  //
+} // of method beginTransmission()                                            //                                  //
+size_t TwoWire::write(const uint8_t data) {                                   // Queue a byte for writing         //
+  if (_TxLength>=WIRE_BUFFER_LENGTH) return 0;                                // Buffer full                      //
+  _TxBuffer[_TxLength++] = data;                                              //                                  //
+  return 1;                                                                   //                                  //
+} // of method write()                                                        //                                  //
+uint8_t TwoWire::endTransmission(const bool sendStop) {                       // Send the queued bytes            //
+  I2CDevice *device = find(_TxAddress);                                       //                                  //
+  if (device==NULL) {                                                         // No acknowledge of address, the   //
+    busTime(0,sendStop);                                                      // bus is held for the HS-mode code //
+    stats.nacks++;                                                            //                                  //
+    return 2;                                                                 // Same code as the AVR library     //
+  } // of if-then no device                                                   //                                  //
+  busTime(_TxLength,sendStop);                                                //                                  //
+  device->receive(_TxBuffer,_TxLength);                                       //                                  //
+  return 0;                                                                   //                                  //
+} // of method endTransmission()                                              //                                  //
+uint8_t TwoWire::requestFrom(const uint8_t address, const uint8_t quantity,   // Read bytes from a device         //
+                             const bool sendStop) {                           //                                  //
+  I2CDevice *device = find(address);                                          //                                  //
+  _RxIndex  = 0;                                                              //                                  //
+  _RxLength = 0;                                                              //                                  //
+  if (device==NULL) {                                                         // No acknowledge of address        //
+    busTime(0,true);                                                          //                                  //
+    stats.nacks++;                                                            //                                  //
+    return 0;                                                                 //                                  //
+  } // of if-then no device                                                   //                                  //
+  uint8_t size = quantity>WIRE_BUFFER_LENGTH ? WIRE_BUFFER_LENGTH : quantity; //                                  //
+  _RxLength = device->transmit(_RxBuffer,size);                               //                                  //
+  busTime(_RxLength,sendStop);                                                //                                  //
+  return _RxLength;                                                           //                                  //
+} // of method requestFrom()                                                  //                                  //
+int TwoWire::available() {return _RxLength-_RxIndex;}                         // Bytes left to read               //
+int TwoWire::read() {                                                         // Read one byte or -1 if none      //
+  if (_RxIndex>=_RxLength) return -1;                                         //                                  //
+  return _RxBuffer[_RxIndex++];                                               //                                  //
+} // of method read()                                                         //----------------------------------//
@@ -0,0 +1,38 @@
+/*******************************************************************************************************************
+** Host replacement for the Arduino EEPROM library. The EEPROM is an erased (0xFF) array in RAM and writes which  **
+** change a byte are counted so that EEPROM wear can be measured.                                                 **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#ifndef EEPROM_h                                                              // Guard code definition            //
+  #define EEPROM_h                                                            // Define the name inside guard     //
+  #include "Arduino.h"                                                        // Arduino data type definitions    //
+  const uint16_t EEPROM_SIZE = 1024;                                          // Same size as an ATmega328P       //
+  class EEPROMClass {                                                         // Simulated EEPROM                 //
+    public:                                                                   // Publicly visible methods         //
+      EEPROMClass() {erase();}                                                // Start with an erased EEPROM      //
+      uint8_t  read(const int address) {return _Data[address%EEPROM_SIZE];}   // Read one byte                    //
+      void     write(const int address, const uint8_t value) {                // Write one byte                   //
+        _Data[address%EEPROM_SIZE] = value; writes++;                         //                                  //
+      } // of method write()                                                  //                                  //
+      void     update(const int address, const uint8_t value) {               // Write byte only when changed     //
+        if (read(address)!=value) write(address,value);                       //                                  //
+      } // of method update()                                                 //                                  //
+      uint16_t length() {return EEPROM_SIZE;}                                 // Size of the EEPROM               //
+      void     erase() {memset(_Data,0xFF,sizeof(_Data));}                    // Set all bytes to 0xFF            //
+      template <typename T> T &get(const int address, T &value) {             // Read any structure               //
+        uint8_t *ptr = (uint8_t*)&value;                                      //                                  //
+        for(size_t i=0;i<sizeof(T);i++) ptr[i] = read(address+i);             //                                  //
+        return value;                                                         //                                  //
+      } // of method get()                                                    //                                  //
+      template <typename T> const T &put(const int address, const T &value) { // Write any structure              //
+        const uint8_t *ptr = (const uint8_t*)&value;                          //                                  //
+        for(size_t i=0;i<sizeof(T);i++) update(address+i,ptr[i]);             //                                  //
+        return value;                                                         //                                  //
+      } // of method put()                                                    //                                  //
+      uint32_t writes = 0;                                                    // Bytes actually written           //
+    private:                                                                  // Private variables and methods    //
+      uint8_t  _Data[EEPROM_SIZE];                                            // EEPROM contents                  //
+  }; // of class EEPROMClass                                                  //                                  //
+  extern EEPROMClass EEPROM;                                                  // Global EEPROM instance           //
+#endif                                                                        //----------------------------------//
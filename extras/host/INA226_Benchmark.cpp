@@ -0,0 +1,184 @@
+/*******************************************************************************************************************
+** Benchmark for the INA226 library on the host. Two simulated INA226 devices are attached to the simulated I2C   **
+** bus running at 400kHz and every public call of the library classes is made once, reporting the number of I2C   **
+** transactions, the bytes on the bus (including address bytes), the time the bus was busy and the total elapsed  **
+** time including delays. As the simulation is deterministic the numbers are exactly reproducible. Serial output  **
+** of the library goes to stderr, only the results are written to stdout.                                         **
+**                                                                                                                **
+** When called with the name of a baseline file the results are compared against it and the program returns a     **
+** non-zero exit code if any call needs more transactions or bytes than recorded in the baseline. Calls which are **
+** missing in the baseline are reported but don't fail. "make check" uses this to catch performance regressions   **
+** and "make baseline" writes a new baseline file after an intended change.                                       **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#include "INA226.h"                                                           // INA226 Library                   //
+#include "INA226_Simulator.h"                                                 // Simulated INA226 devices         //
+#include <stdio.h>                                                            // printf() and file access         //
+#include <string.h>                                                           // strcmp()                         //
+const uint8_t  MAX_RESULTS   =     64;                                        // Maximum number of calls measured //
+const uint32_t I2C_CLOCK     = 400000;                                        // Fast-mode I2C bus                //
+typedef struct {                                                              // Cost of one library call         //
+  char     name[40];                                                          // Name of the call                 //
+  uint32_t transactions;                                                      // I2C transactions                 //
+  uint32_t bytes;                                                             // I2C bytes incl. address bytes    //
+  uint32_t busMicros;                                                         // Time the bus was busy            //
+  uint32_t elapsedMicros;                                                     // Total time incl. delays          //
+} benchResult; // of structure                                                //                                  //
+class NullPrint : public Print {                                              // Discards the telemetry frames    //
+  public:                                                                     //                                  //
+    size_t write(const uint8_t data) {(void)data; return 1;}                  //                                  //
+}; // of class NullPrint                                                      //                                  //
+INA226_Simulator device0(0x40);                                               // Simulated device 0               //
+INA226_Simulator device1(0x41);                                               // Simulated device 1               //
+INA226_Class     INA226;                                                      // INA class instantiation          //
+INA226_Sampler   Sampler(INA226);                                             // Sampling engine instantiation    //
+INA226_Accumulator Accumulator(INA226);                                       // Charge and energy of device 0    //
+INA226_Scheduler Scheduler(INA226);                                           // Polls both devices by deadline   //
+INA226_Statistics Statistics(INA226);                                         // Windowed statistics of device 0  //
+NullPrint        Output;                                                      // Telemetry output                 //
+INA226_Telemetry Telemetry(INA226,Output);                                    // Binary frames of both devices    //
+INA226_DutyCycle DutyCycle(INA226,1);                                         // One-shot sampling of device 1    //
+INA226_Simulator device2(0x40);                                               // Simulated device on Wire1        //
+INA226_WireTransport Bus1(Wire1);                                             // Second bus for FM+ and HS-mode   //
+INA226_Class     FastINA(Bus1);                                               // INA class on the second bus      //
+INA226_Class     ColdStart;                                                   // Instances started from the       //
+INA226_Class     WarmStart;                                                   // EEPROM topology record           //
+benchResult      results[MAX_RESULTS];                                        // Measured calls                   //
+uint8_t          resultCount = 0;                                             // Number of measured calls         //
+/*******************************************************************************************************************
+** Function measure calls "call" once and records the statistics of "bus" and the time it used under "name"       **
+*******************************************************************************************************************/
+template <typename T> void measure(const char *name, T call,                  // Measure one library call         //
+                                   TwoWire &bus=Wire) {                       //                                  //
+  uint64_t start = ArduinoHost::nowMicros();                                  //                                  //
+  bus.stats      = wireStats();                                               // Reset bus counters               //
+  call();                                                                     //                                  //
+  if (resultCount>=MAX_RESULTS) return;                                       //                                  //
+  benchResult &result  = results[resultCount++];                              //                                  //
+  snprintf(result.name,sizeof(result.name),"%s",name);                        //                                  //
+  result.transactions  = bus.stats.transactions;                              //                                  //
+  result.bytes         = bus.stats.bytes;                                     //                                  //
+  result.busMicros     = (uint32_t)bus.stats.busMicros;                       //                                  //
+  result.elapsedMicros = (uint32_t)(ArduinoHost::nowMicros()-start);          //                                  //
+} // of function measure()                                                    //                                  //
+/*******************************************************************************************************************
+** Function compare checks the results against a baseline file, returning the number of calls which got worse     **
+*******************************************************************************************************************/
+int compare(const char *fileName) {                                           // Compare against a baseline       //
+  FILE *file = fopen(fileName,"r");                                           //                                  //
+  if (file==NULL) {                                                           //                                  //
+    fprintf(stderr,"Cannot open baseline file %s\n",fileName);                //                                  //
+    return 1;                                                                 //                                  //
+  } // of if-then file not found                                              //                                  //
+  int      regressions = 0;                                                   //                                  //
+  char     name[40];                                                          //                                  //
+  unsigned transactions, bytes;                                               //                                  //
+  bool     found[MAX_RESULTS] = {};                                           // Calls found in the baseline      //
+  while (fscanf(file,"%39s %u %u%*[^\n]",name,&transactions,&bytes)==3) {     // Read each baseline line          //
+    for(uint8_t i=0;i<resultCount;i++) {                                      // Find the measured call           //
+      if (strcmp(results[i].name,name)!=0) continue;                          //                                  //
+      found[i] = true;                                                        //                                  //
+      if (results[i].transactions>transactions || results[i].bytes>bytes) {   // More bus traffic than before     //
+        printf("REGRESSION %s: %u transactions %u bytes, baseline %u %u\n",   //                                  //
+               name,results[i].transactions,results[i].bytes,transactions,    //                                  //
+               bytes);                                                        //                                  //
+        regressions++;                                                        //                                  //
+      } // of if-then regression                                              //                                  //
+    } // of for-next each result                                              //                                  //
+  } // of while lines in file                                                 //                                  //
+  fclose(file);                                                               //                                  //
+  for(uint8_t i=0;i<resultCount;i++)                                          // Report new calls                 //
+    if (!found[i]) printf("NEW %s is not in the baseline\n",results[i].name); //                                  //
+  return regressions;                                                         //                                  //
+} // of function compare()                                                    //                                  //
+/*******************************************************************************************************************
+** Main program, set up the simulated devices, measure every call and print or compare the results                **
+*******************************************************************************************************************/
+int main(int argc, char *argv[]) {                                            // Main program                     //
+  inaSnapshot snapshot;                                                       // Results of readSnapshot()        //
+  inaSample   samples[4];                                                     // Results of Sampler.read()        //
+  inaEnergy   energy;                                                         // Results of Accumulator.read()    //
+  inaStatistics stats;                                                        // Results of Statistics.read()     //
+  device0.setBusVolts(12.0);  device0.setCurrent( 0.250,0.1);                 // Set simulated measurements       //
+  device1.setBusVolts( 5.0);  device1.setCurrent(-0.125,0.1);                 //                                  //
+  Wire.attach(device0);                                                       // Put the devices on the bus       //
+  Wire.attach(device1);                                                       //                                  //
+  Wire.setClock(I2C_CLOCK);                                                   //                                  //
+  device2.setBusVolts(3.3);   device2.setCurrent( 0.500,0.1);                 //                                  //
+  Wire1.attach(device2);                                                      //                                  //
+  measure("begin",                 []{INA226.begin(1,100000);});              // Scan and calibrate               //
+  measure("begin(device)",         []{INA226.begin(1,100000,1);});            // Calibrate after the scan         //
+  measure("setAveraging",          []{INA226.setAveraging(4);});              // Setters for all devices          //
+  measure("setBusConversion",      []{INA226.setBusConversion(4);});          //                                  //
+  measure("setShuntConversion",    []{INA226.setShuntConversion(4);});        //                                  //
+  measure("setMode",               []{INA226.setMode(INA_MODE_CONTINUOUS_BOTH);});//                              //
+  measure("setAlertPinOnConversion",[]{INA226.setAlertPinOnConversion(false);});//                                //
+  measure("reconfigure(batch)",    []{INA226.beginConfig();                   // All setters written at once      //
+                                      INA226.setAveraging(4);                 //                                  //
+                                      INA226.setBusConversion(4);             //                                  //
+                                      INA226.setShuntConversion(4);           //                                  //
+                                      INA226.setMode(INA_MODE_CONTINUOUS_BOTH);//                                 //
+                                      INA226.setAlertPinOnConversion(false);  //                                  //
+                                      INA226.commit();});                     //                                  //
+  measure("getMode",               []{INA226.getMode(0);});                   //                                  //
+  measure("getConversionMicros",   []{INA226.getConversionMicros(0);});       //                                  //
+  measure("waitForConversion",     []{INA226.waitForConversion(0);});         //                                  //
+  measure("getBusMilliVolts",      []{INA226.getBusMilliVolts(false,0);});    // First read of each register      //
+  measure("getBusMilliVolts(wait)",[]{INA226.getBusMilliVolts(true,0);});     //                                  //
+  measure("getShuntMicroVolts",    []{INA226.getShuntMicroVolts(false,0);});  //                                  //
+  measure("getBusMicroAmps",       []{INA226.getBusMicroAmps(0);});           //                                  //
+  measure("getBusMicroAmps(again)",[]{INA226.getBusMicroAmps(0);});           // Register pointer is unchanged    //
+  measure("getBusMicroWatts",      []{INA226.getBusMicroWatts(0);});          //                                  //
+  measure("getAll4",               []{INA226.getBusMilliVolts(false,0);       // The four getters in a row        //
+                                      INA226.getShuntMicroVolts(false,0);     //                                  //
+                                      INA226.getBusMicroAmps(0);              //                                  //
+                                      INA226.getBusMicroWatts(0);});          //                                  //
+  measure("readSnapshot",          [&]{INA226.readSnapshot(0,snapshot);});    //                                  //
+  measure("startConversion",       []{INA226.startConversion(0);});           //                                  //
+  measure("pollConversion(early)", []{INA226.pollConversion(0);});            // Before the expected end          //
+  measure("pollConversion(ready)", []{delay(10); INA226.pollConversion(0);}); // After the expected end           //
+  measure("Sampler.begin",         []{Sampler.begin(INA_SAMPLE_BUS|           //                                  //
+                                                    INA_SAMPLE_CURRENT,0);}); //                                  //
+  measure("Sampler.sampleISR",     []{delay(10); Sampler.sampleISR(0);});     // A conversion is ready            //
+  measure("Sampler.read",          [&]{Sampler.read(samples,4);});            //                                  //
+  measure("Accumulator.accumulate",[]{delay(10); Accumulator.accumulate();}); // A conversion is ready            //
+  measure("Accumulator.read",      [&]{Accumulator.read(energy);});           //                                  //
+  measure("Scheduler.begin",       []{Scheduler.begin();});                   //                                  //
+  measure("Scheduler.tick",        [&]{delay(10); Scheduler.tick(samples,4);});// Both devices are due            //
+  measure("Statistics.sample",     []{delay(10); Statistics.sample();});      // A conversion is ready            //
+  measure("Statistics.read",       [&]{Statistics.read(stats);});             //                                  //
+  measure("Telemetry.begin",       []{Telemetry.begin();});                   //                                  //
+  measure("Telemetry.sample",      []{delay(10); Telemetry.sample(0);});      // A conversion is ready            //
+  measure("saveDevices",           []{INA226.saveDevices();});                //                                  //
+  measure("restoreDevices",        []{INA226.restoreDevices();});             //                                  //
+  measure("setAlertLimit",         []{INA226.setAlertLimit(                   // Shunt over-limit on device 0     //
+                                        INA_ALERT_SHUNT_OVER,300,0);});       //                                  //
+  measure("setAlertLatch",         []{INA226.setAlertLatch(true,0);});        //                                  //
+  measure("getAlertFlags",         []{INA226.getAlertFlags(0);});             //                                  //
+  measure("reset",                 []{INA226.reset(0);});                     //                                  //
+  measure("fastBegin(scan)",       []{ColdStart.fastBegin(1,100000,512);});   // No record in EEPROM yet          //
+  measure("fastBegin(record)",     []{WarmStart.fastBegin(1,100000,512);});   // Devices confirmed from record    //
+  measure("begin(Wire1)",          []{FastINA.begin(1,100000);},Wire1);       // Through an INA226_WireTransport  //
+  Bus1.setClock(INA_I2C_FAST_PLUS);                                           //                                  //
+  measure("readSnapshot(FM+)",     [&]{FastINA.readSnapshot(0,snapshot);},Wire1);// Fast-mode Plus, 1MHz          //
+  Bus1.setHighSpeed();                                                        //                                  //
+  measure("readSnapshot(HS)",      [&]{FastINA.readSnapshot(0,snapshot);},Wire1);// HS-mode, 2.94MHz              //
+  INA226.setMode(INA_MODE_TRIGGERED_BOTH,1);                                  // Triggered mode on device 1       //
+  measure("getBusMilliVolts(trig)",[]{INA226.getBusMilliVolts(false,1);});    // Read and trigger the next        //
+  measure("DutyCycle.begin",       []{DutyCycle.begin(100000,                 // Power down, alert on conversion  //
+                                                     INA_MODE_TRIGGERED_BOTH,true);});//                          //
+  measure("DutyCycle.trigger",     [&]{DutyCycle.tick(snapshot);});           // First conversion is due          //
+  measure("DutyCycle.tick(alert)", [&]{delay(10); DutyCycle.alertISR();       // Read and power down              //
+                                       DutyCycle.tick(snapshot);});           //                                  //
+  DutyCycle.begin(100000);                                                    // Without the ALERT pin            //
+  delay(100);                                                                 //                                  //
+  DutyCycle.tick(snapshot);                                                   //                                  //
+  measure("DutyCycle.tick(poll)",  [&]{delay(10); DutyCycle.tick(snapshot);});// Flag, read and power down        //
+  printf("%-26s %6s %6s %8s %8s\n","call","trans","bytes","bus_us","time_us");// Print the results                //
+  for(uint8_t i=0;i<resultCount;i++)                                          //                                  //
+    printf("%-26s %6u %6u %8u %8u\n",results[i].name,results[i].transactions, //                                  //
+           results[i].bytes,results[i].busMicros,results[i].elapsedMicros);   //                                  //
+  if (argc>1) return compare(argv[1])==0 ? 0 : 1;                             // Check against baseline           //
+  return 0;                                                                   //                                  //
+} // of main program                                                          //----------------------------------//
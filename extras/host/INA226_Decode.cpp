@@ -0,0 +1,163 @@
+/*******************************************************************************************************************
+** Decoder for the binary frames sent by INA226_Telemetry. The frames are read from the file given on the command **
+** line or from stdin and each sample is written to stdout as a CSV line in the units of readSnapshot(),          **
+** converted by the library from the LSBs in the header frame of its device, so the values are exactly those the  **
+** board read. Samples of devices whose header frame hasn't been seen yet are counted but not written. The stream **
+** is resynchronized on the sync byte and the CRC, and after a sequence gap the delta frames of the device are    **
+** skipped until its next key frame. A summary of the frames decoded, the bytes skipped and the errors found goes **
+** to stderr at the end. To decode the output of a board directly use e.g.                                        **
+**                                                                                                                **
+**   stty -F /dev/ttyACM0 raw 115200 && ./ina226_decode /dev/ttyACM0                                              **
+**                                                                                                                **
+** The frame layout is described in INA226.h, whose constants and conversions are used here. This file is part    **
+** of the host build in extras/host and is never compiled for a real Arduino board.                               **
+*******************************************************************************************************************/
+#include "INA226.h"                                                           // Frame constants and conversions  //
+#include <stdio.h>                                                            // printf() and file access         //
+typedef struct {                                                              // State of one device              //
+  bool     known;                                                             // Header frame has been seen       //
+  bool     synced;                                                            // Delta frames can be decoded      //
+  inaDet   ina;                                                               // Address and LSBs from the header //
+  uint8_t  sequence;                                                          // Sequence number of last frame    //
+  uint32_t timestamp;                                                         // micros() of the last sample      //
+  uint16_t bus;                                                               // Registers of the last sample     //
+  int16_t  shunt;                                                             //                                  //
+  int16_t  current;                                                           //                                  //
+  uint16_t power;                                                             //                                  //
+} deviceState; // of structure                                                //                                  //
+typedef struct {                                                              // Decoder statistics               //
+  uint32_t headers;                                                           // Header frames                    //
+  uint32_t keys;                                                              // Key frames                       //
+  uint32_t deltas;                                                            // Delta frames                     //
+  uint32_t skipped;                                                           // Bytes outside of valid frames    //
+  uint32_t crcErrors;                                                         // Frames with a bad CRC            //
+  uint32_t gaps;                                                              // Sequence number gaps             //
+  uint32_t undecoded;                                                         // Samples which weren't written    //
+} decodeStats; // of structure                                                //                                  //
+deviceState devices[INA_MAX_DEVICES] = {};                                    // State of every device            //
+decodeStats stats                    = {};                                    // Counters for the summary         //
+/*******************************************************************************************************************
+** Functions getWord and getLong read little-endian values out of a frame                                         **
+*******************************************************************************************************************/
+uint16_t getWord(const uint8_t *data) {                                       // Read 2 bytes                     //
+  return data[0]|data[1]<<8;                                                  //                                  //
+} // of function getWord()                                                    //                                  //
+uint32_t getLong(const uint8_t *data) {                                       // Read 4 bytes                     //
+  return getWord(data)|(uint32_t)getWord(data+2)<<16;                         //                                  //
+} // of function getLong()                                                    //                                  //
+/*******************************************************************************************************************
+** Function frameSize returns the size of a frame from its type byte, 0 if the type is unknown                    **
+*******************************************************************************************************************/
+uint8_t frameSize(const uint8_t type) {                                       // Size of a frame type             //
+  if ((type&0x0F)>=INA_MAX_DEVICES) return 0;                                 // Invalid device number            //
+  switch (type&0xF0) {                                                        //                                  //
+    case INA_FRAME_HEADER: return INA_FRAME_HEADER_SIZE;                      //                                  //
+    case INA_FRAME_KEY:    return INA_FRAME_KEY_SIZE;                         //                                  //
+    case INA_FRAME_DELTA:  return INA_FRAME_DELTA_SIZE;                       //                                  //
+  } // of switch frame type                                                   //                                  //
+  return 0;                                                                   //                                  //
+} // of function frameSize()                                                  //                                  //
+/*******************************************************************************************************************
+** Function validFrame checks the CRC-8 (polynomial 0x07) in the last byte of a frame                             **
+*******************************************************************************************************************/
+bool validFrame(const uint8_t *frame, const uint8_t size) {                   // Check the CRC of a frame         //
+  uint8_t crc = 0;                                                            //                                  //
+  for(uint8_t i=0;i<size-1;i++) {                                             // Each byte before the CRC         //
+    crc ^= frame[i];                                                          //                                  //
+    for(uint8_t j=0;j<8;j++) crc = crc&0x80 ? (crc<<1)^0x07 : crc<<1;         // Shift out the 8 bits             //
+  } // of for-next each byte                                                  //                                  //
+  return crc==frame[size-1];                                                  //                                  //
+} // of function validFrame()                                                 //                                  //
+/*******************************************************************************************************************
+** Function decode applies one valid frame to its device's state and writes the sample, if any, as a CSV line     **
+*******************************************************************************************************************/
+void decode(const uint8_t *frame) {                                           // Decode one valid frame           //
+  uint8_t      number = frame[1]&0x0F;                                        // Device number                    //
+  deviceState &device = devices[number];                                      //                                  //
+  switch (frame[1]&0xF0) {                                                    //                                  //
+    case INA_FRAME_HEADER:                                                    // Store the device's LSBs          //
+      stats.headers++;                                                        //                                  //
+      device.known       = true;                                              //                                  //
+      device.ina.address       = frame[2];                                    //                                  //
+      device.ina.configuration = getWord(frame+3);                            //                                  //
+      device.ina.calibration   = getWord(frame+5);                            //                                  //
+      device.ina.current_LSB   = getLong(frame+7);                            // Current LSB in nA                //
+      device.ina.power_LSB     = getLong(frame+11);                           // Power LSB in nW                  //
+      return;                                                                 //                                  //
+    case INA_FRAME_KEY:                                                       // Complete sample                  //
+      stats.keys++;                                                           //                                  //
+      if (device.synced && frame[2]!=(uint8_t)(device.sequence+1))            // Frames were lost                 //
+        stats.gaps++;                                                         //                                  //
+      device.synced    = true;                                                //                                  //
+      device.timestamp = getLong(frame+3);                                    //                                  //
+      device.bus       = getWord(frame+7);                                    //                                  //
+      device.shunt     = getWord(frame+9);                                    //                                  //
+      device.current   = getWord(frame+11);                                   //                                  //
+      device.power     = getWord(frame+13);                                   //                                  //
+      break;                                                                  //                                  //
+    default:                                                                  // Changes since the last frame     //
+      stats.deltas++;                                                         //                                  //
+      if (device.synced && frame[2]!=(uint8_t)(device.sequence+1)) {          // The base sample is lost, wait    //
+        stats.gaps++;                                                         // for the next key frame           //
+        device.synced = false;                                                //                                  //
+      } // of if-then sequence gap                                            //                                  //
+      if (!device.synced) {                                                   //                                  //
+        stats.undecoded++;                                                    //                                  //
+        return;                                                               //                                  //
+      } // of if-then no base sample                                          //                                  //
+      device.timestamp += getWord(frame+3);                                   //                                  //
+      device.bus       += (int8_t)frame[5];                                   //                                  //
+      device.shunt     += (int8_t)frame[6];                                   //                                  //
+      device.current   += (int8_t)frame[7];                                   //                                  //
+      device.power     += (int8_t)frame[8];                                   //                                  //
+  } // of switch frame type                                                   //                                  //
+  device.sequence = frame[2];                                                 //                                  //
+  if (!device.known) {                                                        // LSBs are still unknown           //
+    stats.undecoded++;                                                        //                                  //
+    return;                                                                   //                                  //
+  } // of if-then no header frame                                             //                                  //
+  printf("%u,0x%02X,%u,%u,%d,%d,%d\n",number,device.ina.address,device.timestamp,// Write the sample              //
+         INA226_Class::busToMilliVolts(device.bus),                           // Bus voltage in mV                //
+         INA226_Class::shuntToMicroVolts(device.shunt),                       // Shunt voltage in uV              //
+         INA226_Class::currentToMicroAmps(device.current,device.ina),         // Current in uA                    //
+         INA226_Class::powerToMicroWatts(device.power,device.ina));           // Power in uW                      //
+} // of function decode()                                                     //                                  //
+/*******************************************************************************************************************
+** Main program, read the stream, find and check the frames and decode them                                       **
+*******************************************************************************************************************/
+int main(int argc, char *argv[]) {                                            // Main program                     //
+  FILE *input = argc>1 ? fopen(argv[1],"rb") : stdin;                         // Read from a file or stdin        //
+  if (input==NULL) {                                                          //                                  //
+    fprintf(stderr,"Cannot open %s\n",argv[1]);                               //                                  //
+    return 1;                                                                 //                                  //
+  } // of if-then file not found                                              //                                  //
+  uint8_t buffer[INA_FRAME_MAX_SIZE];                                         // Bytes not decoded yet            //
+  uint8_t length = 0;                                                         // Bytes in the buffer              //
+  int     data;                                                               // Byte read                        //
+  printf("device,address,micros,bus_mV,shunt_uV,current_uA,power_uW\n");      // CSV header line                  //
+  while ((data=getc(input))!=EOF) {                                           // Read each byte                   //
+    buffer[length++] = data;                                                  //                                  //
+    while (length>0) {                                                        // Until more bytes are needed      //
+      uint8_t size = length>1 ? frameSize(buffer[1]) : INA_FRAME_MAX_SIZE;    // Size of the frame in the buffer  //
+      if (buffer[0]==INA_FRAME_SYNC && size>0) {                              // Possible start of a frame        //
+        if (length<size) break;                                               // Frame isn't complete yet         //
+        if (validFrame(buffer,size)) {                                        //                                  //
+          decode(buffer);                                                     //                                  //
+          length -= size;                                                     // Remove the frame                 //
+          memmove(buffer,buffer+size,length);                                 //                                  //
+          continue;                                                           //                                  //
+        } // of if-then valid frame                                           //                                  //
+        stats.crcErrors++;                                                    //                                  //
+      } // of if-then sync byte                                               //                                  //
+      stats.skipped++;                                                        // Drop one byte and look for the   //
+      memmove(buffer,buffer+1,--length);                                      // next sync byte                   //
+    } // of while bytes in buffer                                             //                                  //
+  } // of while bytes in stream                                               //                                  //
+  stats.skipped += length;                                                    // Incomplete frame at the end      //
+  if (input!=stdin) fclose(input);                                            //                                  //
+  fprintf(stderr,"%u header, %u key and %u delta frames, %u bytes skipped, "  // Summary                          //
+          "%u CRC errors, %u sequence gaps, %u samples not decoded\n",        //                                  //
+          stats.headers,stats.keys,stats.deltas,stats.skipped,stats.crcErrors,//                                  //
+          stats.gaps,stats.undecoded);                                        //                                  //
+  return 0;                                                                   //                                  //
+} // of main program                                                          //----------------------------------//
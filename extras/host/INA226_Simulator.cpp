@@ -0,0 +1,173 @@
+/*******************************************************************************************************************
+** INA226_Simulator class method definitions, see INA226_Simulator.h for a description of the simulation.         **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#include "INA226_Simulator.h"                                                 // Include the header definition    //
+static const uint16_t conversionTimes[8] = {140,204,332,588,1100,2116,4156,   // Conversion times in us from      //
+                                            8244};                            // the datasheet, per setting       //
+static const uint16_t averagingCounts[8] = {1,4,16,64,128,256,512,1024};      // Averages per setting             //
+const uint16_t SIM_MASK_WRITABLE = 0xFC03;                                    // Writable mask/enable bits        //
+const uint16_t SIM_ALERT_FLAG    = 0x0010;                                    // AFF  bit 4                       //
+const uint16_t SIM_CONV_READY    = 0x0008;                                    // CVRF bit 3                       //
+const uint16_t SIM_OVERFLOW      = 0x0004;                                    // OVF  bit 2                       //
+const uint16_t SIM_POLARITY      = 0x0002;                                    // APOL bit 1                       //
+const uint16_t SIM_LATCH         = 0x0001;                                    // LEN  bit 0                       //
+INA226_Simulator::INA226_Simulator(const uint8_t address) {                   // Class constructor                //
+  _Address = address;                                                         //                                  //
+  powerCycle();                                                               // Start with power-on values       //
+} // of class constructor                                                     //                                  //
+/*******************************************************************************************************************
+** Method powerCycle sets all registers to their power-on reset values and starts a conversion as the device      **
+** does after power-up in the default continuous mode                                                             **
+*******************************************************************************************************************/
+void INA226_Simulator::powerCycle() {                                         // Power-on reset of the device     //
+  _Pointer         = 0;                                                       //                                  //
+  _Config          = 0x4127;                                                  // Datasheet default value          //
+  _Shunt           = 0;                                                       //                                  //
+  _Bus             = 0;                                                       //                                  //
+  _Power           = 0;                                                       //                                  //
+  _Current         = 0;                                                       //                                  //
+  _Calibration     = 0;                                                       //                                  //
+  _MaskEnable      = 0;                                                       //                                  //
+  _AlertLimit      = 0;                                                       //                                  //
+  _Pending         = false;                                                   //                                  //
+  _ConversionStart = ArduinoHost::nowMicros();                                //                                  //
+} // of method powerCycle()                                                   //                                  //
+/*******************************************************************************************************************
+** Method conversionMicros returns the duration of one complete conversion, the averaging count times the bus     **
+** and/or shunt conversion time depending upon which of the two are enabled in the mode bits                      **
+*******************************************************************************************************************/
+uint32_t INA226_Simulator::conversionMicros() {                               // Duration of one conversion       //
+  uint32_t duration = 0;                                                      //                                  //
+  if (_Config&1) duration += conversionTimes[(_Config>>3)&7];                 // Shunt measurement enabled        //
+  if (_Config&2) duration += conversionTimes[(_Config>>6)&7];                 // Bus measurement enabled          //
+  return duration*averagingCounts[(_Config>>9)&7];                            //                                  //
+} // of method conversionMicros()                                             //                                  //
+/*******************************************************************************************************************
+** Method update completes all conversions which have become due since the last bus access. In continuous mode    **
+** conversions follow each other back-to-back, in triggered mode only one conversion is made per trigger          **
+*******************************************************************************************************************/
+void INA226_Simulator::update() {                                             // Complete due conversions         //
+  uint64_t now      = ArduinoHost::nowMicros();                               //                                  //
+  uint32_t duration = conversionMicros();                                     //                                  //
+  if (duration==0) return;                                                    // Power-down mode                  //
+  if (_Config&4) {                                                            // Continuous mode                  //
+    if (now<_ConversionStart+duration) return;                                // Conversion still running         //
+    uint64_t completed = (now-_ConversionStart)/duration;                     // Conversions since last update    //
+    conversions      += completed-1;                                          // Only the last one is visible     //
+    _ConversionStart += completed*duration;                                   //                                  //
+    convert();                                                                //                                  //
+  } else if (_Pending && now>=_ConversionStart+duration) {                    // Triggered conversion finished    //
+    _Pending = false;                                                         //                                  //
+    convert();                                                                //                                  //
+  } // of if-then-else continuous or triggered                                //                                  //
+} // of method update()                                                       //                                  //
+/*******************************************************************************************************************
+** Method convert computes the result registers from the simulated voltages and evaluates the alert functions     **
+*******************************************************************************************************************/
+void INA226_Simulator::convert() {                                            // Compute measurement results      //
+  _BusVolts += _BusRamp;                                                      // Voltage changing over time       //
+  double shunt = round(_ShuntVolts/0.0000025);                                // 2.5uV shunt LSB                  //
+  double bus   = round(_BusVolts/0.00125);                                    // 1.25mV bus LSB                   //
+  bool   overflow = false;                                                    //                                  //
+  if (shunt> 32767) {shunt =  32767; overflow = true;}                        // Clamp to register range          //
+  if (shunt<-32768) {shunt = -32768; overflow = true;}                        //                                  //
+  if (bus<0)        bus   = 0;                                                //                                  //
+  if (bus>32767)    bus   = 32767;                                            //                                  //
+  if (_Config&1) _Shunt = (int16_t)shunt;                                     // Only enabled measurements are    //
+  if (_Config&2) _Bus   = (uint16_t)bus;                                      // updated by a conversion          //
+  int32_t current = (int32_t)_Shunt*_Calibration/2048;                        // Datasheet equation 3             //
+  if (current> 32767) {current =  32767; overflow = true;}                    //                                  //
+  if (current<-32768) {current = -32768; overflow = true;}                    //                                  //
+  _Current = (int16_t)current;                                                //                                  //
+  _Power   = (uint16_t)((uint32_t)(current<0?-current:current)*_Bus/20000);   // Datasheet equation 4             //
+  bool tripped = false;                                                       // Check the alert function         //
+  if      (_MaskEnable&0x8000) tripped = _Shunt>(int16_t)_AlertLimit;         // SOL shunt over limit             //
+  else if (_MaskEnable&0x4000) tripped = _Shunt<(int16_t)_AlertLimit;         // SUL shunt under limit            //
+  else if (_MaskEnable&0x2000) tripped = _Bus>_AlertLimit;                    // BOL bus over limit               //
+  else if (_MaskEnable&0x1000) tripped = _Bus<_AlertLimit;                    // BUL bus under limit              //
+  else if (_MaskEnable&0x0800) tripped = _Power>_AlertLimit;                  // POL power over limit             //
+  if (tripped) _MaskEnable |= SIM_ALERT_FLAG;                                 // Latched or transparent, AFF is   //
+  else if (!(_MaskEnable&SIM_LATCH)) _MaskEnable &= ~SIM_ALERT_FLAG;          // cleared by next good result      //
+  if (overflow) _MaskEnable |= SIM_OVERFLOW;                                  //                                  //
+           else _MaskEnable &= ~SIM_OVERFLOW;                                 //                                  //
+  _MaskEnable |= SIM_CONV_READY;                                              // Set conversion ready flag        //
+  conversions++;                                                              //                                  //
+} // of method convert()                                                      //                                  //
+/*******************************************************************************************************************
+** Method alertPin returns the electrical level of the open-drain ALERT pin, it is active when a limit function   **
+** has tripped or when the conversion ready alert is enabled and a conversion has finished                        **
+*******************************************************************************************************************/
+bool INA226_Simulator::alertPin() {                                           // Electrical level of ALERT pin    //
+  update();                                                                   //                                  //
+  bool active = ((_MaskEnable&0xF800) && (_MaskEnable&SIM_ALERT_FLAG)) ||     // Limit function tripped or        //
+                ((_MaskEnable&0x0400) && (_MaskEnable&SIM_CONV_READY));       // conversion ready alert           //
+  return (_MaskEnable&SIM_POLARITY) ? active : !active;                       // Default polarity active-low      //
+} // of method alertPin()                                                     //                                  //
+/*******************************************************************************************************************
+** Method peek returns a register value without any of the side effects of a bus read                             **
+*******************************************************************************************************************/
+uint16_t INA226_Simulator::peek(const uint8_t reg) {                          // Register without side effects    //
+  update();                                                                   //                                  //
+  switch (reg) {                                                              //                                  //
+    case 0:    return _Config;                                                //                                  //
+    case 1:    return (uint16_t)_Shunt;                                       //                                  //
+    case 2:    return _Bus;                                                   //                                  //
+    case 3:    return _Power;                                                 //                                  //
+    case 4:    return (uint16_t)_Current;                                     //                                  //
+    case 5:    return _Calibration;                                           //                                  //
+    case 6:    return _MaskEnable;                                            //                                  //
+    case 7:    return _AlertLimit;                                            //                                  //
+    case 0xFE: return 0x5449;                                                 // Manufacturer ID "TI"             //
+    case 0xFF: return 0x2260;                                                 // Die ID                           //
+    default:   return 0;                                                      //                                  //
+  } // of switch register                                                     //                                  //
+} // of method peek()                                                         //                                  //
+/*******************************************************************************************************************
+** Method writeRegister applies a register write. Writing the configuration register either resets the device or  **
+** aborts the running conversion and starts a new one, which also triggers a conversion in triggered mode         **
+*******************************************************************************************************************/
+void INA226_Simulator::writeRegister(const uint8_t reg, const uint16_t value) {// Register write side effects     //
+  update();                                                                   //                                  //
+  registerWrites++;                                                           //                                  //
+  switch (reg) {                                                              //                                  //
+    case 0:                                                                   // Configuration register           //
+      if (value&0x8000) {powerCycle(); break;}                                // Reset bit set                    //
+      _Config          = value|0x4000;                                        // Bit 14 always reads as 1         //
+      _MaskEnable     &= ~SIM_CONV_READY;                                     // Writing clears CVRF              //
+      _ConversionStart = ArduinoHost::nowMicros();                            // Start new conversion             //
+      _Pending         = !(value&4) && (value&3);                             // Triggered one-shot               //
+      break;                                                                  //                                  //
+    case 5: _Calibration = value&0x7FFF; break;                               // Bit 15 is reserved               //
+    case 6: _MaskEnable  = (_MaskEnable&~SIM_MASK_WRITABLE)|                  // Keep read-only flags             //
+                           (value&SIM_MASK_WRITABLE); break;                  //                                  //
+    case 7: _AlertLimit  = value; break;                                      //                                  //
+    default: break;                                                           // Read-only register               //
+  } // of switch register                                                     //                                  //
+} // of method writeRegister()                                                //                                  //
+/*******************************************************************************************************************
+** Method receive handles a write from the master, the first byte sets the register pointer and two more bytes    **
+** are written to the register it points to                                                                       **
+*******************************************************************************************************************/
+void INA226_Simulator::receive(const uint8_t *data, const uint8_t size) {     // Pointer or register write        //
+  if (size==0) return;                                                        // Address probe only               //
+  _Pointer = data[0];                                                         //                                  //
+  if (size>=3) writeRegister(_Pointer,(uint16_t)data[1]<<8|data[2]);          // Write register value             //
+          else pointerWrites++;                                               //                                  //
+} // of method receive()                                                      //                                  //
+/*******************************************************************************************************************
+** Method transmit returns the register at the pointer, most significant byte first. Reading the mask/enable      **
+** register clears the conversion ready flag and, in latch mode, the alert function flag                          **
+*******************************************************************************************************************/
+uint8_t INA226_Simulator::transmit(uint8_t *data, const uint8_t size) {       // Register read                    //
+  uint16_t value = peek(_Pointer);                                            //                                  //
+  registerReads++;                                                            //                                  //
+  if (_Pointer==6) {                                                          // Reading mask/enable register     //
+    _MaskEnable &= ~SIM_CONV_READY;                                           // clears the ready flag            //
+    if (_MaskEnable&SIM_LATCH) _MaskEnable &= ~SIM_ALERT_FLAG;                // and latched alert flag           //
+  } // of if-then mask/enable register                                        //                                  //
+  for(uint8_t i=0;i<size;i++) data[i] = (i&1) ? (uint8_t)value                // The device repeats the           //
+                                              : (uint8_t)(value>>8);          // register for longer reads        //
+  return size;                                                                //                                  //
+} // of method transmit()                                                     //----------------------------------//
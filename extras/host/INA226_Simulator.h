@@ -0,0 +1,57 @@
+/*******************************************************************************************************************
+** Register-accurate simulation of a Texas Instruments INA226 for the host build. The simulator implements the    **
+** register pointer, configuration, calibration, mask/enable and alert limit registers, the conversion timing for **
+** every averaging and conversion time setting, the continuous, triggered and power-down modes as well as the     **
+** conversion ready and limit alert flags with the ALERT pin. Measurements are computed from the bus and shunt    **
+** voltages set by the caller using the same integer arithmetic as the device datasheet.                          **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#ifndef INA226_Simulator_h                                                    // Guard code definition            //
+  #define INA226_Simulator_h                                                  // Define the name inside guard     //
+  #include "Wire.h"                                                           // Simulated I2C bus                //
+  class INA226_Simulator : public I2CDevice {                                 // Simulated INA226 device          //
+    public:                                                                   // Publicly visible methods         //
+      INA226_Simulator(const uint8_t address);                                // Class constructor                //
+      uint8_t  address() {return _Address;}                                   // 7-bit I2C address of device      //
+      bool     present() {return _Present;}                                   // false makes the device NACK      //
+      void     receive(const uint8_t *data, const uint8_t size);              // Pointer or register write        //
+      uint8_t  transmit(uint8_t *data, const uint8_t size);                   // Register read                    //
+      void     setPresent(const bool present) {_Present = present;}           // Simulate device dropping off     //
+      void     setBusVolts(const double volts) {_BusVolts = volts;}           // Set measured bus voltage         //
+      void     setBusRamp(const double volts) {_BusRamp = volts;}             // Bus voltage change per conversion//
+      void     setShuntVolts(const double volts) {_ShuntVolts = volts;}       // Set measured shunt voltage       //
+      void     setCurrent(const double amps, const double shuntOhms) {        // Set shunt voltage from current   //
+        _ShuntVolts = amps*shuntOhms;                                         //                                  //
+      } // of method setCurrent()                                             //                                  //
+      void     powerCycle();                                                  // Power-on reset of the device     //
+      bool     alertPin();                                                    // Electrical level of ALERT pin    //
+      uint16_t peek(const uint8_t reg);                                       // Register without side effects    //
+      uint8_t  pointer() const {return _Pointer;}                             // Current register pointer         //
+      uint32_t conversionMicros();                                            // Duration of one conversion       //
+      uint32_t conversions   = 0;                                             // Completed conversions            //
+      uint32_t pointerWrites = 0;                                             // Writes setting only pointer      //
+      uint32_t registerWrites= 0;                                             // Writes of a register value       //
+      uint32_t registerReads = 0;                                             // Register reads                   //
+    private:                                                                  // Private variables and methods    //
+      void     update();                                                      // Complete due conversions         //
+      void     convert();                                                     // Compute measurement results      //
+      void     writeRegister(const uint8_t reg, const uint16_t value);        // Register write side effects      //
+      uint8_t  _Address;                                                      // I2C address                      //
+      bool     _Present     = true;                                           // Device answers on the bus        //
+      double   _BusVolts    = 0;                                              // Simulated bus voltage            //
+      double   _BusRamp     = 0;                                              // Added to it by each conversion   //
+      double   _ShuntVolts  = 0;                                              // Simulated shunt voltage          //
+      uint8_t  _Pointer     = 0;                                              // Register pointer                 //
+      uint16_t _Config;                                                       // Configuration register           //
+      int16_t  _Shunt;                                                        // Shunt voltage register           //
+      uint16_t _Bus;                                                          // Bus voltage register             //
+      uint16_t _Power;                                                        // Power register                   //
+      int16_t  _Current;                                                      // Current register                 //
+      uint16_t _Calibration;                                                  // Calibration register             //
+      uint16_t _MaskEnable;                                                   // Mask/Enable register             //
+      uint16_t _AlertLimit;                                                   // Alert limit register             //
+      uint64_t _ConversionStart;                                              // Start of running conversion      //
+      bool     _Pending;                                                      // Triggered conversion running     //
+  }; // of class INA226_Simulator                                             //                                  //
+#endif                                                                        //----------------------------------//
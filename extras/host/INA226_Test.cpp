@@ -0,0 +1,706 @@
+/*******************************************************************************************************************
+** Functional tests for the INA226 library on the host. Each test attaches the simulated INA226 devices to the    **
+** simulated I2C bus, sets known voltages and currents and checks the values and states the library reports       **
+** against them. A line is printed for every failed check and the program returns a non-zero exit code if any     **
+** check failed, "make check" runs it together with the benchmark.                                                **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#include "INA226.h"                                                           // INA226 Library                   //
+#include "INA226_Simulator.h"                                                 // Simulated INA226 devices         //
+#include <EEPROM.h>                                                           // Simulated EEPROM                 //
+#include <stdio.h>                                                            // printf()                         //
+INA226_Simulator device0(0x40);                                               // Simulated device 0               //
+INA226_Simulator device1(0x41);                                               // Simulated device 1               //
+INA226_Simulator device2(0x40);                                               // Simulated device on Wire1        //
+uint16_t         checks   = 0;                                                // Number of checks made            //
+uint16_t         failures = 0;                                                // Number of checks failed          //
+/*******************************************************************************************************************
+** Function expect counts a check and reports it when "passed" is false                                           **
+*******************************************************************************************************************/
+void expect(const char *name, const bool passed) {                            // Count and report one check       //
+  checks++;                                                                   //                                  //
+  if (passed) return;                                                         //                                  //
+  failures++;                                                                 //                                  //
+  printf("FAIL %s\n",name);                                                   //                                  //
+} // of function expect()                                                     //                                  //
+/*******************************************************************************************************************
+** Function expectNear checks that "value" is within "tolerance" of "expected" and reports both values if not     **
+*******************************************************************************************************************/
+void expectNear(const char *name, const int64_t value, const int64_t expected,// Check a value with tolerance     //
+                const int64_t tolerance) {                                    //                                  //
+  bool passed = value>=expected-tolerance && value<=expected+tolerance;       //                                  //
+  expect(name,passed);                                                        //                                  //
+  if (!passed) printf("     got %lld, expected %lld +-%lld\n",(long long)value,//                                 //
+                      (long long)expected,(long long)tolerance);              //                                  //
+} // of function expectNear()                                                 //                                  //
+/*******************************************************************************************************************
+** Function setup powers the simulated devices up with 12V and 0.25A through 0.1 Ohm on device 0 and 5V and       **
+** -0.125A on device 1                                                                                            **
+*******************************************************************************************************************/
+void setup() {                                                                // Known state for each test        //
+  device0.powerCycle();     device1.powerCycle();                             //                                  //
+  device0.setPresent(true); device1.setPresent(true);                         //                                  //
+  device0.setBusVolts(12.0);  device0.setCurrent( 0.250,0.1);                 //                                  //
+  device1.setBusVolts( 5.0);  device1.setCurrent(-0.125,0.1);                 //                                  //
+} // of function setup()                                                      //                                  //
+/*******************************************************************************************************************
+** Function conversionDone is the callback of pollConversion() in testConversion()                                **
+*******************************************************************************************************************/
+uint8_t conversionCallbacks = 0;                                              // Times the callback ran           //
+void conversionDone(const uint8_t deviceNumber) {                             // pollConversion() callback        //
+  if (deviceNumber==0) conversionCallbacks++;                                 //                                  //
+} // of function conversionDone()                                             //                                  //
+/*******************************************************************************************************************
+** Test the non-blocking and the blocking wait for a conversion. pollConversion() mustn't touch the bus before    **
+** the expected end, then reports the conversion once and calls the callback, and times out when the device stops **
+** answering. waitForConversion() sleeps through a long averaging conversion with only a few bus transactions and **
+** gives up after twice the conversion time when the device doesn't answer.                                       **
+*******************************************************************************************************************/
+void testConversion() {                                                       // Poll and wait for conversions    //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  ina.setAveraging(4,0);                                                      //                                  //
+  ina.setConversionCallback(conversionDone);                                  //                                  //
+  uint32_t duration = ina.getConversionMicros(0);                             //                                  //
+  expect("pollConversion idle",ina.pollConversion(0)==INA_CONVERSION_IDLE);   //                                  //
+  ina.startConversion(0);                                                     //                                  //
+  uint32_t transactions = Wire.stats.transactions;                            //                                  //
+  expect("pollConversion pending",ina.pollConversion(0)==INA_CONVERSION_PENDING);//                               //
+  expect("pollConversion no bus access early",Wire.stats.transactions==transactions);//                           //
+  delayMicroseconds(duration);                                                //                                  //
+  uint8_t state;                                                              //                                  //
+  while ((state=ina.pollConversion(0))==INA_CONVERSION_PENDING) delayMicroseconds(50);//                          //
+  expect("pollConversion ready",state==INA_CONVERSION_READY && conversionCallbacks==1);//                         //
+  expect("pollConversion idle after ready",ina.pollConversion(0)==INA_CONVERSION_IDLE);//                         //
+  ina.startConversion(0);                                                     //                                  //
+  device0.setPresent(false);                                                  // Device drops off the bus         //
+  delayMicroseconds(2*duration+INA_CONVERSION_SLACK+1);                       //                                  //
+  expect("pollConversion timeout",ina.pollConversion(0)==INA_CONVERSION_TIMEOUT);//                               //
+  device0.setPresent(true);                                                   //                                  //
+  ina.setAveraging(1024,0);                                                   // About 2.3s per conversion        //
+  duration = ina.getConversionMicros(0);                                      //                                  //
+  ina.waitForConversion(0);                                                   // Clear the flag                   //
+  transactions = Wire.stats.transactions;                                     //                                  //
+  uint32_t start = micros();                                                  //                                  //
+  expect("waitForConversion ready",ina.waitForConversion(0));                 //                                  //
+  expectNear("waitForConversion wait",micros()-start,duration,duration/16);   // Up to one conversion             //
+  expect("waitForConversion few transactions",Wire.stats.transactions-transactions<=4);//                         //
+  device0.setPresent(false);                                                  //                                  //
+  start = micros();                                                           //                                  //
+  expect("waitForConversion timeout",!ina.waitForConversion(0));              //                                  //
+  expectNear("waitForConversion timeout after 2 conversions",micros()-start,  //                                  //
+             2*duration+INA_CONVERSION_SLACK,INA_CONVERSION_POLL_MAX+100);    //                                  //
+  ina.setConversionCallback(NULL);                                            //                                  //
+} // of function testConversion()                                             //                                  //
+/*******************************************************************************************************************
+** Test INA226_Fixed against INA226_Class::begin() with the same maximum current and shunt. The calibration has   **
+** to be identical and the readings may differ by rounding only, less than 0.03% of full scale.                   **
+*******************************************************************************************************************/
+void testFixed() {                                                            // INA226_Fixed vs INA226_Class     //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  uint16_t calibration = device0.peek(INA_CALIBRATION_REGISTER);              //                                  //
+  delay(10);                                                                  // Let a conversion finish          //
+  int32_t  microAmps   = ina.getBusMicroAmps(0);                              //                                  //
+  int32_t  microWatts  = ina.getBusMicroWatts(0);                             //                                  //
+  INA226_Fixed<1,100000> fixed;                                               //                                  //
+  expect("Fixed.begin finds both devices",fixed.begin()==2);                  //                                  //
+  expect("Fixed calibration",device0.peek(INA_CALIBRATION_REGISTER)==         //                                  //
+                             calibration && calibration!=0);                  //                                  //
+  delay(10);                                                                  //                                  //
+  expectNear("Fixed.getBusMicroAmps",fixed.getBusMicroAmps(0),microAmps,      //                                  //
+             microAmps/3333+1);                                               //                                  //
+  expectNear("Fixed.getBusMicroWatts",fixed.getBusMicroWatts(0),microWatts,   //                                  //
+             microWatts/3333+1);                                              //                                  //
+} // of function testFixed()                                                  //                                  //
+/*******************************************************************************************************************
+** Test that all current APIs report the same physical scale, 0.25A through 0.1 Ohm with a 1A range being         **
+** 250000uA within 0.1% as the calibration register is rounded down, and that the accumulated charge agrees with  **
+** the integrated current                                                                                         **
+*******************************************************************************************************************/
+void testCurrentScale() {                                                     // Current in uA everywhere         //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  delay(10);                                                                  //                                  //
+  expectNear("getBusMicroAmps 0.25A",ina.getBusMicroAmps(0),250000,250);      //                                  //
+  expectNear("getBusMicroAmps -0.125A",ina.getBusMicroAmps(1),-125000,125);   //                                  //
+  expectNear("getBusMicroWatts 3W",ina.getBusMicroWatts(0),3000000,3000);     // Power LSB is 25 current LSBs     //
+  inaSnapshot snapshot;                                                       //                                  //
+  ina.readSnapshot(0,snapshot);                                               //                                  //
+  expectNear("readSnapshot.busMicroAmps",snapshot.busMicroAmps,250000,250);   //                                  //
+  INA226_Fixed<1,100000> fixed;                                               //                                  //
+  fixed.begin();                                                              //                                  //
+  delay(10);                                                                  //                                  //
+  expectNear("Fixed.getBusMicroAmps 0.25A",fixed.getBusMicroAmps(0),250000,250);//                                //
+  INA226_Statistics statistics(ina);                                          //                                  //
+  inaStatistics     stats;                                                    //                                  //
+  statistics.setWindow(4);                                                    //                                  //
+  for(uint8_t i=0;i<4;i++) {                                                  // Fill one tumbling window         //
+    delay(10);                                                                //                                  //
+    statistics.sample();                                                      //                                  //
+  } // of for-next each sample                                                //                                  //
+  expect("Statistics window complete",statistics.read(stats));                //                                  //
+  expectNear("Statistics mean current",stats.busMicroAmps.mean,250000,250);   //                                  //
+  INA226_Accumulator accumulator(ina);                                        //                                  //
+  inaEnergy          energy;                                                  //                                  //
+  uint32_t           start = millis();                                        //                                  //
+  while (millis()-start<36000) {                                              // 36s at 0.25A are 2500uAh         //
+    delayMicroseconds(ina.getConversionMicros(0)/4);                          // Read every conversion            //
+    accumulator.accumulate();                                                 //                                  //
+  } // of while integrating                                                   //                                  //
+  accumulator.read(energy);                                                   //                                  //
+  expectNear("Accumulator.read microAmpHours",energy.microAmpHours,2500,25);  // Within 1%                        //
+  noInterrupts();                                                             // As inside an interrupt handler   //
+  accumulator.read(energy);                                                   //                                  //
+  accumulator.reset();                                                        //                                  //
+  expect("Accumulator keeps interrupts disabled",!(SREG&0x80));               //                                  //
+  interrupts();                                                               //                                  //
+} // of function testCurrentScale()                                           //                                  //
+/*******************************************************************************************************************
+** Test that alert limits use the same scale as the getters. The limits are set 20% below and above the current   **
+** and power read by getBusMicroAmps() and getBusMicroWatts() and the bus voltage read by getBusMilliVolts(),     **
+** converted to mA, mW and mV, so that each over-limit below and each under-limit above the reading trips and the **
+** others don't.                                                                                                  **
+*******************************************************************************************************************/
+void testAlertLimits() {                                                      // Limits in mA, mV and mW          //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  delay(10);                                                                  //                                  //
+  const int32_t milliAmps  = ina.getBusMicroAmps(0)/1000;                     // 250mA                            //
+  const int32_t milliWatts = ina.getBusMicroWatts(0)/1000;                    // 3000mW                           //
+  const int32_t milliVolts = ina.getBusMilliVolts(false,0);                   // 12000mV                          //
+  const struct {                                                              // Limit and expected result        //
+    const char *name;                                                         //                                  //
+    uint16_t    function;                                                     //                                  //
+    int32_t     limit;                                                        //                                  //
+    bool        trips;                                                        //                                  //
+  } cases[] = {                                                               //                                  //
+    {"SHUNT_OVER below current trips",  INA_ALERT_SHUNT_OVER, milliAmps*4/5, true },//                            //
+    {"SHUNT_OVER above current doesn't",INA_ALERT_SHUNT_OVER, milliAmps*6/5, false},//                            //
+    {"SHUNT_UNDER above current trips", INA_ALERT_SHUNT_UNDER,milliAmps*6/5, true },//                            //
+    {"POWER_OVER below power trips",    INA_ALERT_POWER_OVER, milliWatts*4/5,true },//                            //
+    {"POWER_OVER above power doesn't",  INA_ALERT_POWER_OVER, milliWatts*6/5,false},//                            //
+    {"BUS_UNDER below voltage doesn't", INA_ALERT_BUS_UNDER,  milliVolts*4/5,false},//                            //
+    {"BUS_OVER below voltage trips",    INA_ALERT_BUS_OVER,   milliVolts*4/5,true },//                            //
+  }; // of test cases                                                         //                                  //
+  for(uint8_t i=0;i<sizeof(cases)/sizeof(cases[0]);i++) {                     // Each limit on its own            //
+    ina.setAlertLimit(cases[i].function,cases[i].limit,0);                    //                                  //
+    delay(10);                                                                // Let a conversion compare it      //
+    bool tripped = ina.getAlertFlags(0)&cases[i].function;                    //                                  //
+    expect(cases[i].name,tripped==cases[i].trips);                            //                                  //
+  } // of for-next each case                                                  //                                  //
+} // of function testAlertLimits()                                            //                                  //
+/*******************************************************************************************************************
+** Test that a latched alert survives reads of the mask/enable register made by other methods, which clear the    **
+** alert function flag in the device, and that getAlertFlags() reports it once                                    **
+*******************************************************************************************************************/
+void testLatchedAlert() {                                                     // Alert not lost by other reads    //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  ina.setAlertLatch(true,0);                                                  //                                  //
+  ina.setAlertLimit(INA_ALERT_SHUNT_OVER,200,0);                              // Trips at 250mA                   //
+  delay(10);                                                                  //                                  //
+  ina.getBusMicroAmps(0);                                                     // Simulator converts on bus access //
+  device0.setCurrent(0.1,0.1);                                                // Below the limit again            //
+  delay(10);                                                                  //                                  //
+  inaSnapshot snapshot;                                                       //                                  //
+  ina.readSnapshot(0,snapshot);                                               // Reads and clears the AFF         //
+  expect("latched trip kept by readSnapshot",                                 //                                  //
+         ina.getAlertFlags(0)&INA_ALERT_SHUNT_OVER);                          //                                  //
+  expect("trip reported once",!(ina.getAlertFlags(0)&INA_ALERT_SHUNT_OVER));  //                                  //
+  device0.setCurrent(0.25,0.1);                                               // Trip again                       //
+  delay(10);                                                                  //                                  //
+  ina.getBusMicroAmps(0);                                                     //                                  //
+  device0.setCurrent(0.1,0.1);                                                //                                  //
+  delay(10);                                                                  //                                  //
+  INA226_Sampler sampler(ina);                                                //                                  //
+  sampler.sampleISR(0);                                                       // Reads from the interrupt         //
+  expect("latched trip kept by sampleISR",                                    //                                  //
+         ina.getAlertFlags(0)&INA_ALERT_SHUNT_OVER);                          //                                  //
+} // of function testLatchedAlert()                                           //                                  //
+/*******************************************************************************************************************
+** Function alertHandler is raised as the interrupt of the ALERT pin and captures a sample with the Sampler       **
+*******************************************************************************************************************/
+INA226_Sampler *alertSampler       = NULL;                                    // Sampler used by the handler      //
+uint8_t         alertHandlerCalls  = 0;                                       // Times the handler ran            //
+void alertHandler() {                                                         // Simulated ALERT interrupt        //
+  alertHandlerCalls++;                                                        //                                  //
+  alertSampler->sampleISR(0);                                                 //                                  //
+} // of function alertHandler()                                               //                                  //
+/*******************************************************************************************************************
+** Test getAlertFlags() interleaved with Sampler captures from the ALERT interrupt. A trip the handler captured   **
+** has to be reported by the next getAlertFlags(). Called with interrupts disabled, getAlertFlags() has to leave  **
+** them disabled so that a raised interrupt stays pending until the caller enables them again.                    **
+*******************************************************************************************************************/
+void testAlertInterleaved() {                                                 // Flags vs the Sampler ISR         //
+  setup();                                                                    //                                  //
+  INA226_Class   ina;                                                         //                                  //
+  INA226_Sampler sampler(ina);                                                //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  alertSampler      = &sampler;                                               //                                  //
+  alertHandlerCalls = 0;                                                      //                                  //
+  ina.setAlertLatch(true,0);                                                  //                                  //
+  ina.setAlertLimit(INA_ALERT_SHUNT_OVER,200,0);                              // Trips at 250mA                   //
+  delay(10);                                                                  //                                  //
+  ArduinoHost::raiseInterrupt(alertHandler);                                  // Taken at once, reads the AFF     //
+  device0.setCurrent(0.1,0.1);                                                // Below the limit again            //
+  delay(10);                                                                  //                                  //
+  expect("trip captured by the ISR reported",ina.getAlertFlags(0)&INA_ALERT_SHUNT_OVER);//                        //
+  device0.setCurrent(0.25,0.1);                                               //                                  //
+  delay(10);                                                                  //                                  //
+  noInterrupts();                                                             // As inside another handler        //
+  ArduinoHost::raiseInterrupt(alertHandler);                                  // Stays pending                    //
+  ina.getAlertFlags(0);                                                       //                                  //
+  expect("getAlertFlags keeps interrupts disabled",!(SREG&0x80) && alertHandlerCalls==1);//                       //
+  delay(10);                                                                  // Trips again                      //
+  interrupts();                                                               // Handler reads the AFF            //
+  expect("pending interrupt taken when enabled",alertHandlerCalls==2);        //                                  //
+  device0.setCurrent(0.1,0.1);                                                //                                  //
+  delay(10);                                                                  //                                  //
+  expect("trip captured after enabling reported",ina.getAlertFlags(0)&INA_ALERT_SHUNT_OVER);//                    //
+  alertSampler = NULL;                                                        //                                  //
+} // of function testAlertInterleaved()                                       //                                  //
+/*******************************************************************************************************************
+** Test sliding windows of one sample, asked for with a length of 1 or 0. Every new sample replaces the only one  **
+** in the window, so the statistics have to follow the current with no variance.                                  **
+*******************************************************************************************************************/
+void testStatisticsOneSample() {                                              // Sliding window of one sample     //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  INA226_Statistics statistics(ina);                                          //                                  //
+  inaStatistics     stats;                                                    //                                  //
+  for(uint8_t length=0;length<2;length++) {                                   // Both lengths give one sample     //
+    statistics.setWindow(length,INA_WINDOW_SLIDING);                          //                                  //
+    const float amps[] = {0.25,0.1,0.2};                                      // Current of each sample           //
+    for(uint8_t i=0;i<3;i++) {                                                //                                  //
+      device0.setCurrent(amps[i],0.1);                                        //                                  //
+      delay(10);                                                              //                                  //
+      expect("one-sample window complete",statistics.sample());               //                                  //
+      statistics.read(stats);                                                 //                                  //
+      expect("one-sample window size",stats.samples==1);                      //                                  //
+      expectNear("one-sample window mean",stats.busMicroAmps.mean,amps[i]*1000000,//                              //
+                 250);                                                        //                                  //
+      expect("one-sample window no variance",stats.busMicroAmps.variance==0 &&//                                  //
+             stats.busMicroAmps.minimum==stats.busMicroAmps.maximum);         //                                  //
+    } // of for-next each sample                                              //                                  //
+  } // of for-next each length                                                //                                  //
+  noInterrupts();                                                             // As inside an interrupt handler   //
+  statistics.read(stats);                                                     //                                  //
+  statistics.reset();                                                         //                                  //
+  expect("Statistics keeps interrupts disabled",!(SREG&0x80));                //                                  //
+  interrupts();                                                               //                                  //
+} // of function testStatisticsOneSample()                                    //                                  //
+/*******************************************************************************************************************
+** Class FramePrint writes the frames sent by INA226_Telemetry to a file for the decoder                          **
+*******************************************************************************************************************/
+class FramePrint : public Print {                                             // Frames to a file                 //
+  public:                                                                     // Publicly visible methods         //
+    FILE *file = NULL;                                                        // File written to                  //
+    size_t write(const uint8_t data) {                                        // Write a single byte              //
+      return fputc(data,file)==EOF ? 0 : 1;                                   //                                  //
+    } // of method write()                                                    //                                  //
+}; // of class FramePrint                                                     //                                  //
+/*******************************************************************************************************************
+** Test that ina226_decode turns INA226_Telemetry frames into the values readSnapshot() returns for the same      **
+** conversion. Both devices send a key frame and then a delta frame after a small change of the current, the      **
+** frames are decoded by running ina226_decode and its CSV lines are compared with the snapshots.                 **
+*******************************************************************************************************************/
+void testTelemetryRoundTrip() {                                               // Encoder and decoder agree        //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  FramePrint       frames;                                                    //                                  //
+  INA226_Telemetry telemetry(ina,frames);                                     //                                  //
+  inaSnapshot      snapshots[2][2];                                           // Per frame and device             //
+  frames.file = fopen("ina226_test.frames","wb");                             //                                  //
+  telemetry.begin();                                                          // Header frames                    //
+  for(uint8_t i=0;i<2;i++) {                                                  // A key and a delta frame          //
+    delay(10);                                                                //                                  //
+    for(uint8_t device=0;device<2;device++) {                                 //                                  //
+      expect("Telemetry.sample sends a frame",telemetry.sample(device));      //                                  //
+      ina.readSnapshot(device,snapshots[i][device]);                          // Same conversion                  //
+    } // of for-next each device                                              //                                  //
+    device0.setCurrent(0.251,0.1);                                            // Small enough for a delta frame   //
+  } // of for-next each frame                                                 //                                  //
+  fclose(frames.file);                                                        //                                  //
+  FILE    *decoded = popen("./ina226_decode ina226_test.frames 2>/dev/null","r");//                               //
+  char     line[80];                                                          //                                  //
+  unsigned number,address,timestamp,milliVolts;                               // Fields of a CSV line             //
+  int      microVolts,microAmps,microWatts;                                   //                                  //
+  expect("ina226_decode writes the CSV header",fgets(line,sizeof(line),decoded)!=NULL);//                         //
+  for(uint8_t i=0;i<2;i++) {                                                  //                                  //
+    for(uint8_t device=0;device<2;device++) {                                 //                                  //
+      const inaSnapshot &snapshot = snapshots[i][device];                     //                                  //
+      bool matches = fgets(line,sizeof(line),decoded)!=NULL &&                //                                  //
+                     sscanf(line,"%u,0x%x,%u,%u,%d,%d,%d",&number,&address,&timestamp,//                          //
+                            &milliVolts,&microVolts,&microAmps,&microWatts)==7 &&//                               //
+                     number==device &&                                        //                                  //
+                     milliVolts==snapshot.busMilliVolts &&                    //                                  //
+                     microVolts==snapshot.shuntMicroVolts &&                  //                                  //
+                     microAmps==snapshot.busMicroAmps &&                      //                                  //
+                     microWatts==snapshot.busMicroWatts;                      //                                  //
+      expect("decoded frame matches readSnapshot",matches);                   //                                  //
+      if (!matches) printf("     got %s",line);                               //                                  //
+    } // of for-next each device                                              //                                  //
+  } // of for-next each frame                                                 //                                  //
+  pclose(decoded);                                                            //                                  //
+  remove("ina226_test.frames");                                               //                                  //
+} // of function testTelemetryRoundTrip()                                     //                                  //
+/*******************************************************************************************************************
+** Test fastBegin(). Without a record it scans the bus, with one it leaves devices which kept their settings      **
+** alone. When the maximum current changed only the new calibration is written, not the recorded one first, and a **
+** bad CRC, a record of another version or a missing device make it scan the bus again.                           **
+*******************************************************************************************************************/
+void testFastBegin() {                                                        // Restore from the EEPROM record   //
+  setup();                                                                    //                                  //
+  EEPROM.erase();                                                             //                                  //
+  INA226_Class cold,warm,changed,crc,version,missing;                         //                                  //
+  expect("fastBegin scans without a record",cold.fastBegin(1,100000,0)==2);   //                                  //
+  device0.registerWrites = 0;                                                 //                                  //
+  EEPROM.writes          = 0;                                                 //                                  //
+  expect("fastBegin restores the record",warm.fastBegin(1,100000,0)==2);      //                                  //
+  expect("nothing written for a kept record",                                 // No bus or EEPROM writes          //
+         device0.registerWrites==0 && EEPROM.writes==0);                      //                                  //
+  uint16_t calibration = device0.peek(INA_CALIBRATION_REGISTER);              //                                  //
+  device0.powerCycle();                                                       // Device lost its calibration      //
+  device0.registerWrites = 0;                                                 //                                  //
+  expect("fastBegin with a new current",changed.fastBegin(2,100000,0)==2);    //                                  //
+  expect("only the new calibration written",device0.registerWrites==1 &&      //                                  //
+         device0.peek(INA_CALIBRATION_REGISTER)!=calibration);                //                                  //
+  EEPROM.write(2+2*sizeof(inaDet),EEPROM.read(2+2*sizeof(inaDet))^1);         // Bad CRC                          //
+  device0.registerWrites = 0;                                                 //                                  //
+  expect("bad CRC scans the bus",crc.fastBegin(2,100000,0)==2 &&              // Reset and calibration written    //
+         device0.registerWrites==2);                                          //                                  //
+  EEPROM.write(0,EEPROM.read(0)+1);                                           // Another record version           //
+  device0.registerWrites = 0;                                                 //                                  //
+  expect("other version scans the bus",version.fastBegin(2,100000,0)==2 &&    //                                  //
+         device0.registerWrites==2);                                          //                                  //
+  device1.setPresent(false);                                                  // Recorded device is missing       //
+  device0.registerWrites = 0;                                                 //                                  //
+  expect("missing device scans the bus",missing.fastBegin(2,100000,0)==1 &&   //                                  //
+         device0.registerWrites==2);                                          //                                  //
+} // of function testFastBegin()                                              //                                  //
+/*******************************************************************************************************************
+** Test the register pointer cache. A second read of the same register doesn't write the pointer again, while a   **
+** write to another register and a failed transfer make the next read set the pointer first.                      **
+*******************************************************************************************************************/
+void testPointerCache() {                                                     // Pointer written only if needed   //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  ina.getBusMilliVolts(false,0);                                              // Pointer now at the bus register  //
+  device0.pointerWrites = 0;                                                  //                                  //
+  ina.getBusMilliVolts(false,0);                                              //                                  //
+  expect("cached pointer not written",device0.pointerWrites==0);              //                                  //
+  ina.setAveraging(4,0);                                                      // Write moves the pointer          //
+  expectNear("bus voltage after a write",ina.getBusMilliVolts(false,0),12000,2);//                                //
+  expect("pointer written after a write",device0.pointerWrites==1);           //                                  //
+  device0.setPresent(false);                                                  // Failed transfer                  //
+  ina.getBusMilliVolts(false,0);                                              //                                  //
+  device0.powerCycle();                                                       // Pointer back to configuration    //
+  device0.setPresent(true);                                                   //                                  //
+  delay(10);                                                                  //                                  //
+  device0.pointerWrites = 0;                                                  //                                  //
+  expectNear("bus voltage after a failure",ina.getBusMilliVolts(false,0),12000,2);//                              //
+  expect("pointer written after a failure",device0.pointerWrites==1);         //                                  //
+} // of function testPointerCache()                                           //                                  //
+/*******************************************************************************************************************
+** Test that readSnapshot() returns the results of one conversion when a conversion finishes during the burst of  **
+** register reads. The bus voltage rises by 0.5V with each conversion, so a power register from a newer           **
+** conversion than the bus voltage register would differ from their product by about 4%. The snapshot is taken at **
+** shifting times so that some bursts are interrupted by a conversion and read again.                             **
+*******************************************************************************************************************/
+void testSnapshotReRead() {                                                   // Results of one conversion        //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  device0.setBusRamp(0.5);                                                    //                                  //
+  uint8_t reReads = 0;                                                        // Bursts read twice                //
+  for(uint8_t i=0;i<40;i++) {                                                 //                                  //
+    delayMicroseconds(1000+37*i);                                             // Shift against the conversions    //
+    uint32_t reads = device0.registerReads;                                   //                                  //
+    inaSnapshot snapshot;                                                     //                                  //
+    ina.readSnapshot(0,snapshot);                                             //                                  //
+    if (device0.registerReads-reads>6) reReads++;                             // Mask, results and mask again     //
+    int64_t product = (int64_t)snapshot.busMilliVolts*snapshot.busMicroAmps/1000;//                               //
+    expectNear("snapshot from one conversion",snapshot.busMicroWatts,product,product/1000+25);//                  //
+  } // of for-next each snapshot                                              //                                  //
+  expect("snapshot read again after a conversion",reReads>0);                 //                                  //
+  device0.setBusRamp(0);                                                      //                                  //
+} // of function testSnapshotReRead()                                         //                                  //
+/*******************************************************************************************************************
+** Test the Sampler ring buffer. Once it is full further conversions are dropped and counted by getOverflows(),   **
+** the samples already buffered are kept in order, and after read() has made room new samples are captured again. **
+*******************************************************************************************************************/
+void testSamplerOverflow() {                                                  // Full ring buffer                 //
+  setup();                                                                    //                                  //
+  INA226_Class   ina;                                                         //                                  //
+  INA226_Sampler sampler(ina);                                                //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  sampler.begin(INA_SAMPLE_BUS,0);                                            //                                  //
+  for(uint8_t i=0;i<INA_SAMPLE_BUFFER_SIZE+3;i++) {                           // Three more than fit              //
+    device0.setBusVolts(1+i);                                                 // Marks the conversion             //
+    delay(3);                                                                 // One conversion                   //
+    sampler.sampleISR(0);                                                     //                                  //
+  } // of for-next each conversion                                            //                                  //
+  expect("full buffer holds all it can",sampler.available()==INA_SAMPLE_BUFFER_SIZE);//                           //
+  expect("overflows counted",sampler.getOverflows()==3);                      //                                  //
+  sampler.sampleISR(0);                                                       // No new conversion yet            //
+  expect("no overflow without a conversion",sampler.getOverflows()==3);       //                                  //
+  inaSample samples[INA_SAMPLE_BUFFER_SIZE];                                  //                                  //
+  uint8_t   count = sampler.read(samples,INA_SAMPLE_BUFFER_SIZE);             //                                  //
+  bool      oldest = count==INA_SAMPLE_BUFFER_SIZE;                           // Oldest samples kept in order     //
+  for(uint8_t i=0;i<count;i++) oldest = oldest && samples[i].busMilliVolts==1000*(1+i);//                         //
+  expect("buffered samples kept in order",oldest);                            //                                  //
+  device0.setBusVolts(12.0);                                                  //                                  //
+  delay(3);                                                                   //                                  //
+  sampler.sampleISR(0);                                                       //                                  //
+  expect("sampling resumes after read",sampler.available()==1 && sampler.getOverflows()==3);//                    //
+} // of function testSamplerOverflow()                                        //                                  //
+/*******************************************************************************************************************
+** Test that beginConfig() collects the setter changes and commit() writes each changed register once, however    **
+** many setters changed it, and nothing for registers or devices which weren't changed                            **
+*******************************************************************************************************************/
+void testCommit() {                                                           // One write per dirty register     //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  device0.registerWrites = 0;                                                 //                                  //
+  device1.registerWrites = 0;                                                 //                                  //
+  ina.beginConfig();                                                          //                                  //
+  ina.setAveraging(64);                                                       // Configuration of both devices    //
+  ina.setBusConversion(7);                                                    //                                  //
+  ina.setShuntConversion(7);                                                  //                                  //
+  ina.setAlertPinOnConversion(true,0);                                        // Mask/enable of device 0          //
+  ina.setAlertLatch(true,0);                                                  //                                  //
+  expect("setters don't write in a batch",device0.registerWrites==0 && device1.registerWrites==0);//              //
+  expect("commit makes three writes",ina.commit()==3);                        //                                  //
+  expect("one write per changed register",device0.registerWrites==2 && device1.registerWrites==1);//              //
+  expect("committed configuration in the device",device1.peek(INA_CONFIGURATION_REGISTER)==//                     //
+         (0x4127|0x0600|0x01F8));                                             // 64 averages, 8.244ms             //
+  expect("nothing left to commit",ina.commit()==0 && device0.registerWrites==2);//                                //
+  ina.setAveraging(1,1);                                                      // Outside a batch                  //
+  expect("setter writes directly after commit",device1.registerWrites==2);    //                                  //
+} // of function testCommit()                                                 //                                  //
+/*******************************************************************************************************************
+** Test the Scheduler statistics. Ticks made when the devices are due take every conversion without missing any   **
+** and with a slip of less than a period. A loop which stalls for three periods counts one missed conversion for  **
+** each whole period of slip and resynchronizes, so that the following on-time ticks add no more missed           **
+** conversions.                                                                                                   **
+*******************************************************************************************************************/
+void testSchedulerStats() {                                                   // Missed and slip counters         //
+  setup();                                                                    //                                  //
+  INA226_Class     ina;                                                       //                                  //
+  INA226_Scheduler scheduler(ina);                                            //                                  //
+  inaSample        samples[2];                                                //                                  //
+  inaScheduleStats stats;                                                     //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  scheduler.begin();                                                          //                                  //
+  for(uint8_t i=0;i<20;i++) {                                                 // On time                          //
+    delayMicroseconds(scheduler.getMicrosToNext());                           //                                  //
+    scheduler.tick(samples,2);                                                //                                  //
+  } // of for-next each tick                                                  //                                  //
+  scheduler.getStats(0,stats);                                                //                                  //
+  expect("no missed conversions on time",stats.samples>0 && stats.missed==0); //                                  //
+  expect("slip below a period on time",stats.maxSlip<stats.conversionMicros); //                                  //
+  delayMicroseconds(scheduler.getMicrosToNext()+3*stats.conversionMicros);    // Stall the loop                   //
+  while (scheduler.tick(samples,2)==0) delayMicroseconds(scheduler.getMicrosToNext());//                          //
+  scheduler.getStats(0,stats);                                                //                                  //
+  uint32_t missed = stats.missed;                                             //                                  //
+  expect("stalled loop misses conversions",missed>=2 &&                       // Deadline of the other device     //
+         missed==stats.maxSlip/stats.conversionMicros);                       // may have come first              //
+  expect("stall reported as slip",stats.maxSlip>=2*stats.conversionMicros);   //                                  //
+  for(uint8_t i=0;i<20;i++) {                                                 // On time again                    //
+    delayMicroseconds(scheduler.getMicrosToNext());                           //                                  //
+    scheduler.tick(samples,2);                                                //                                  //
+  } // of for-next each tick                                                  //                                  //
+  scheduler.getStats(0,stats);                                                //                                  //
+  expect("resynchronized after the stall",stats.missed==missed);              //                                  //
+  scheduler.resetStats();                                                     //                                  //
+  scheduler.getStats(0,stats);                                                //                                  //
+  expect("resetStats clears the counters",stats.samples==0 && stats.missed==0 && stats.maxSlip==0);//             //
+} // of function testSchedulerStats()                                         //                                  //
+/*******************************************************************************************************************
+** Class CountingTransport is a custom transport for testTransport() which passes all transfers on to Wire and    **
+** counts them                                                                                                    **
+*******************************************************************************************************************/
+class CountingTransport : public INA226_Transport {                           // Custom transport counting calls  //
+  public:                                                                     // Publicly visible methods         //
+    void    begin() {begins++; _Bus.begin();}                                 // Prepare the bus                  //
+    uint8_t write(const uint8_t deviceAddress, const uint8_t *data,           // Write bytes to a device          //
+                  const uint8_t size, const bool sendStop) {                  //                                  //
+      writes++;                                                               //                                  //
+      return _Bus.write(deviceAddress,data,size,sendStop);                    //                                  //
+    } // of method write()                                                    //                                  //
+    uint8_t read(const uint8_t deviceAddress, uint8_t *data,                  // Read bytes from a device         //
+                 const uint8_t size) {                                        //                                  //
+      reads++;                                                                //                                  //
+      return _Bus.read(deviceAddress,data,size);                              //                                  //
+    } // of method read()                                                     //                                  //
+    uint32_t begins = 0;                                                      // Calls of each method             //
+    uint32_t writes = 0;                                                      //                                  //
+    uint32_t reads  = 0;                                                      //                                  //
+  private:                                                                    // Private variables and methods    //
+    INA226_WireTransport _Bus;                                                // Wire transport doing the work    //
+}; // of class CountingTransport                                              //                                  //
+/*******************************************************************************************************************
+** Test the transport selection. An instance on Wire1 only finds and reads the device on that bus, starts Wire1   **
+** once unless told not to and sets the chosen clock, without any traffic on Wire. A custom transport carries all **
+** transfers of its instance.                                                                                     **
+*******************************************************************************************************************/
+void testTransport() {                                                        // Wire1 and a custom transport     //
+  setup();                                                                    //                                  //
+  device2.powerCycle();                                                       //                                  //
+  device2.setBusVolts(3.3);                                                   //                                  //
+  INA226_WireTransport bus1(Wire1);                                           //                                  //
+  bus1.setClock(INA_I2C_FAST_PLUS);                                           //                                  //
+  INA226_Class         ina1(bus1);                                            //                                  //
+  uint32_t begins       = Wire1.begins();                                     //                                  //
+  uint32_t transactions = Wire.stats.transactions;                            //                                  //
+  expect("Wire1 instance finds its device",ina1.begin(1,100000)==1);          //                                  //
+  expectNear("Wire1 instance reads its device",ina1.getBusMilliVolts(false,0),3300,2);//                          //
+  expect("Wire1 started with the clock set",Wire1.begins()==begins+1 && Wire1.clock()==INA_I2C_FAST_PLUS);//      //
+  expect("no traffic on Wire",Wire.stats.transactions==transactions);         //                                  //
+  INA226_WireTransport sketchStarted(Wire1,false);                            // Sketch calls Wire1.begin()       //
+  INA226_Class         ina2(sketchStarted);                                   //                                  //
+  begins = Wire1.begins();                                                    //                                  //
+  ina2.begin(1,100000);                                                       //                                  //
+  expect("Wire1 not started when told not to",Wire1.begins()==begins);        //                                  //
+  CountingTransport custom;                                                   //                                  //
+  INA226_Class      ina3(custom);                                             //                                  //
+  expect("custom transport instance finds both devices",ina3.begin(1,100000)==2);//                               //
+  uint32_t reads = custom.reads;                                              //                                  //
+  expectNear("custom transport reads",ina3.getBusMilliVolts(false,1),5000,2); //                                  //
+  expect("transfers go through the custom transport",                         //                                  //
+         custom.begins>0 && custom.writes>0 && custom.reads>reads);           //                                  //
+} // of function testTransport()                                              //                                  //
+/*******************************************************************************************************************
+** Test the DutyCycle miss and timeout paths. When polling a result is read once the conversion has finished, a   **
+** trigger the device doesn't acknowledge and a device which stops answering during the conversion each count as  **
+** missed after the timeout. With the ALERT pin the result is read after alertISR() without looking at the bus    **
+** before, and a lost interrupt is recovered by reading the ready flag after the timeout.                         **
+*******************************************************************************************************************/
+void testDutyCycle() {                                                        // Missed and timeout paths         //
+  setup();                                                                    //                                  //
+  INA226_Class     ina;                                                       //                                  //
+  INA226_DutyCycle duty(ina,0);                                               //                                  //
+  inaSnapshot      snapshot;                                                  //                                  //
+  inaDutyStats     stats;                                                     //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  duty.begin(10000);                                                          // Polling, 10ms period             //
+  duty.getStats(stats);                                                       //                                  //
+  uint32_t timeout = 2*stats.conversionMicros+INA_CONVERSION_SLACK+1;         //                                  //
+  expect("trigger returns no result",!duty.tick(snapshot));                   //                                  //
+  delayMicroseconds(duty.getMicrosToNext());                                  //                                  //
+  bool read = false;                                                          //                                  //
+  for(uint8_t i=0;i<10 && !(read=duty.tick(snapshot));i++) delayMicroseconds(50);//                               //
+  expect("polled result read",read);                                          //                                  //
+  expectNear("polled result value",snapshot.busMilliVolts,12000,2);           //                                  //
+  device0.setPresent(false);                                                  // Trigger not acknowledged         //
+  delayMicroseconds(duty.getMicrosToNext());                                  //                                  //
+  duty.tick(snapshot);                                                        //                                  //
+  duty.getStats(stats);                                                       //                                  //
+  expect("failed trigger counted as missed",stats.missed==1 && stats.cycles==1);//                                //
+  device0.setPresent(true);                                                   //                                  //
+  delayMicroseconds(duty.getMicrosToNext());                                  //                                  //
+  duty.tick(snapshot);                                                        // Triggered                        //
+  device0.setPresent(false);                                                  // Drops off during the conversion  //
+  delayMicroseconds(stats.conversionMicros);                                  //                                  //
+  expect("no result before the timeout",!duty.tick(snapshot));                //                                  //
+  duty.getStats(stats);                                                       //                                  //
+  expect("not missed before the timeout",stats.missed==1);                    //                                  //
+  delayMicroseconds(timeout);                                                 //                                  //
+  expect("no result after the timeout",!duty.tick(snapshot));                 //                                  //
+  duty.getStats(stats);                                                       //                                  //
+  expect("timed out conversion counted as missed",stats.missed==2 && stats.cycles==1);//                          //
+  device0.setPresent(true);                                                   //                                  //
+  duty.begin(10000,INA_MODE_TRIGGERED_BOTH,true);                             // Using the ALERT pin              //
+  duty.tick(snapshot);                                                        // Triggered                        //
+  delayMicroseconds(stats.conversionMicros);                                  //                                  //
+  uint32_t transactions = Wire.stats.transactions;                            //                                  //
+  expect("waits for alertISR",!duty.tick(snapshot) && !device0.alertPin());   // ALERT pin is active low          //
+  expect("no bus access while waiting",Wire.stats.transactions==transactions);//                                  //
+  duty.alertISR();                                                            //                                  //
+  expect("result read after alertISR",duty.tick(snapshot));                   //                                  //
+  delayMicroseconds(duty.getMicrosToNext());                                  //                                  //
+  duty.tick(snapshot);                                                        // Triggered, interrupt lost        //
+  delayMicroseconds(timeout);                                                 //                                  //
+  expect("lost interrupt recovered after the timeout",duty.tick(snapshot));   //                                  //
+  duty.getStats(stats);                                                       //                                  //
+  expect("alert cycles counted",stats.cycles==3 && stats.missed==2);          //                                  //
+  duty.end();                                                                 //                                  //
+} // of function testDutyCycle()                                              //                                  //
+#ifdef INA_INSTRUMENTATION                                                    // Only when instrumented           //
+/*******************************************************************************************************************
+** Test that the instrumentation counters agree with the bus. A pointer write followed by a read after a repeated **
+** start is one transaction, the bytes of both transfers are counted and a device which doesn't answer counts as  **
+** a NACK.                                                                                                        **
+*******************************************************************************************************************/
+void testInstrumentation() {                                                  // Counters vs the simulated bus    //
+  setup();                                                                    //                                  //
+  INA226_Class ina;                                                           //                                  //
+  ina.begin(1,100000);                                                        //                                  //
+  ina.resetInstrumentation();                                                 //                                  //
+  Wire.stats = wireStats();                                                   //                                  //
+  inaSnapshot snapshot;                                                       //                                  //
+  ina.readSnapshot(0,snapshot);                                               // Repeated starts                  //
+  ina.getBusMilliVolts(0);                                                    // Stop after the pointer           //
+  ina.getAlertFlags(0);                                                       //                                  //
+  ina.setAveraging(16,0);                                                     // Register writes                  //
+  inaBusCounters device,reg,sum = {0,0,0,0,0};                                //                                  //
+  ina.getBusCounters(0,device);                                               //                                  //
+  for(uint8_t addr=0;addr<INA_REGISTER_SLOTS;addr++) {                        // Sum over all registers           //
+    ina.getRegisterCounters(addr,reg);                                        //                                  //
+    sum.transactions += reg.transactions;                                     //                                  //
+    sum.bytes        += reg.bytes;                                            //                                  //
+  } // of for-next each register                                              //                                  //
+  expect("transactions match the bus",device.transactions==Wire.stats.transactions);//                            //
+  expect("bytes match the bus",device.bytes==Wire.stats.bytes);               //                                  //
+  expect("registers sum to the device",sum.transactions==device.transactions &&//                                 //
+         sum.bytes==device.bytes);                                            //                                  //
+  device0.setPresent(false);                                                  // Device drops off the bus         //
+  ina.resetInstrumentation();                                                 //                                  //
+  Wire.stats = wireStats();                                                   //                                  //
+  ina.getBusMilliVolts(0);                                                    //                                  //
+  ina.getBusCounters(0,device);                                               //                                  //
+  expect("NACK counted",device.nacks==Wire.stats.nacks && device.nacks>0);    //                                  //
+  expect("no bytes counted for a NACK",device.bytes==0);                      //                                  //
+} // of function testInstrumentation()                                        //                                  //
+#endif                                                                        // of if-then instrumentation       //
+/*******************************************************************************************************************
+** Main program, run all tests and fail if any check failed                                                       **
+*******************************************************************************************************************/
+int main() {                                                                  // Main program                     //
+  Wire.attach(device0);                                                       // Put the devices on the bus       //
+  Wire.attach(device1);                                                       //                                  //
+  Wire1.attach(device2);                                                      //                                  //
+  Wire.setClock(400000);                                                      //                                  //
+  testConversion();                                                           //                                  //
+  testFixed();                                                                //                                  //
+  testCurrentScale();                                                         //                                  //
+  testAlertLimits();                                                          //                                  //
+  testLatchedAlert();                                                         //                                  //
+  testAlertInterleaved();                                                     //                                  //
+  testStatisticsOneSample();                                                  //                                  //
+  testTelemetryRoundTrip();                                                   //                                  //
+  testFastBegin();                                                            //                                  //
+  testPointerCache();                                                         //                                  //
+  testSnapshotReRead();                                                       //                                  //
+  testSamplerOverflow();                                                      //                                  //
+  testCommit();                                                               //                                  //
+  testSchedulerStats();                                                       //                                  //
+  testTransport();                                                            //                                  //
+  testDutyCycle();                                                            //                                  //
+  #ifdef INA_INSTRUMENTATION                                                  // Only when instrumented           //
+    testInstrumentation();                                                    //                                  //
+  #endif                                                                      // of if-then instrumentation       //
+  printf("%u checks, %u failed\n",checks,failures);                           //                                  //
+  return failures==0 ? 0 : 1;                                                 //                                  //
+} // of main program                                                          //----------------------------------//
@@ -0,0 +1,66 @@
+/*******************************************************************************************************************
+** Host replacement for the Arduino Wire library. Transfers are routed to simulated devices attached to the       **
+** bus with attach(). Every transfer advances the simulated clock by the time the bytes would take on a real      **
+** bus at the clock rate set with setClock() and is counted, so the benchmark can report the cost of each call.   **
+**                                                                                                                **
+** This file is part of the host build in extras/host and is never compiled for a real Arduino board.             **
+*******************************************************************************************************************/
+#ifndef TwoWire_h                                                             // Guard code definition            //
+  #define TwoWire_h                                                           // Define the name inside guard     //
+  #include "Arduino.h"                                                        // Arduino data type definitions    //
+  const uint8_t WIRE_BUFFER_LENGTH = 32;                                      // Same buffer size as the AVR      //
+  const uint8_t WIRE_MAX_DEVICES   = 16;                                      // Devices attachable to one bus    //
+  /*****************************************************************************************************************
+  ** Declare the interface implemented by simulated I2C devices                                                   **
+  *****************************************************************************************************************/
+  class I2CDevice {                                                           // Simulated I2C slave device       //
+    public:                                                                   // Publicly visible methods         //
+      virtual ~I2CDevice() {}                                                 // Virtual destructor               //
+      virtual uint8_t address() = 0;                                          // 7-bit I2C address of device      //
+      virtual bool    present() {return true;}                                // false makes the device NACK      //
+      virtual void    receive(const uint8_t *data, const uint8_t size) = 0;   // Master wrote bytes to device     //
+      virtual uint8_t transmit(uint8_t *data, const uint8_t size) = 0;        // Master reads bytes from device   //
+  }; // of class I2CDevice                                                    //                                  //
+  typedef struct {                                                            // Statistics for the bus           //
+    uint32_t transactions;                                                    // Start to stop sequences          //
+    uint32_t bytes;                                                           // Bytes incl. address bytes        //
+    uint32_t nacks;                                                           // Address not acknowledged         //
+    uint64_t busMicros;                                                       // Time spent on the bus            //
+  } wireStats; // of structure                                                //                                  //
+  /*****************************************************************************************************************
+  ** Declare the TwoWire class                                                                                    **
+  *****************************************************************************************************************/
+  class TwoWire {                                                             // Simulated I2C bus master         //
+    public:                                                                   // Publicly visible methods         //
+      void    begin();                                                        // Start the bus                    //
+      void    setClock(const uint32_t clockHz);                               // Set the bus clock speed          //
+      void    beginTransmission(const uint8_t address);                       // Start a write to a device        //
+      size_t  write(const uint8_t data);                                      // Queue a byte for writing         //
+      uint8_t endTransmission(const bool sendStop=true);                      // Send the queued bytes            //
+      uint8_t requestFrom(const uint8_t address, const uint8_t quantity,      // Read bytes from a device         //
+                          const bool sendStop=true);                          //                                  //
+      int     available();                                                    // Bytes left to read               //
+      int     read();                                                         // Read one byte or -1 if none      //
+      void      attach(I2CDevice &device);                                    // Add simulated device to bus      //
+      void      detachAll();                                                  // Remove all devices from bus      //
+      wireStats stats;                                                        // Counters, reset them freely      //
+      uint32_t  clock()   const {return _ClockHz;}                            // Current clock in Hz              //
+      uint32_t  begins()  const {return _Begins;}                             // Number of begin() calls          //
+    private:                                                                  // Private variables and methods    //
+      I2CDevice *find(const uint8_t address);                                 // Find attached device             //
+      void       busTime(const uint8_t bytes, const bool stop);               // Advance clock for transfer       //
+      I2CDevice *_Devices[WIRE_MAX_DEVICES] = {};                             // Attached devices                 //
+      uint8_t    _DeviceCount  = 0;                                           // Number of attached devices       //
+      uint32_t   _ClockHz      = 100000;                                      // Arduino default is 100kHz        //
+      uint32_t   _Begins       = 0;                                           // Number of begin() calls          //
+      uint8_t    _TxAddress    = 0;                                           // Address being written to         //
+      uint8_t    _TxBuffer[WIRE_BUFFER_LENGTH];                               // Bytes queued for writing         //
+      uint8_t    _TxLength     = 0;                                           // Number of bytes queued           //
+      uint8_t    _RxBuffer[WIRE_BUFFER_LENGTH];                               // Bytes received                   //
+      uint8_t    _RxLength     = 0;                                           // Number of bytes received         //
+      uint8_t    _RxIndex      = 0;                                           // Next byte to return              //
+      bool       _Repeated     = false;                                       // Last transfer held the bus       //
+  }; // of class TwoWire                                                      //                                  //
+  extern TwoWire Wire;                                                        // Global I2C bus instance          //
+  extern TwoWire Wire1;                                                       // Second bus, as on e.g. the Due   //
+#endif                                                                        //----------------------------------//